@@ -4,8 +4,24 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
-
-// Material do objeto
+flat in uint MaterialIndex;
+
+// Funcionalidades fixadas na compilação (ShaderVariants injeta os #defines
+// a seguir ao #version); os valores abaixo valem sem defines
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 2   // luzes da cena (sol e preenchimento), sem a lanterna
+#endif
+#ifndef CAMERA_LIGHT
+#define CAMERA_LIGHT 1  // lanterna da câmara
+#endif
+#ifndef GAMMA
+#define GAMMA 1
+#endif
+#ifndef FOG
+#define FOG 0           // nevoeiro exponencial até à cor do horizonte
+#endif
+
+// Material do objeto (layout std140 espelhado em GpuMaterial)
 struct Material {
     vec3 ambient;
     vec3 diffuse;
@@ -13,15 +29,31 @@ struct Material {
     float shininess;
 };
 
-uniform Material material;
+// Materiais do Mesh, carregados uma vez (IndirectDraw::MAX_MATERIALS)
+layout (std140, binding = 0) uniform MaterialBlock {
+    Material materials[256];
+};
+
+Material material;
 
-// Luzes
-uniform vec3 lightPos1;
-uniform vec3 lightPos2;
-uniform vec3 lightPos3;     // luz da câmara
-uniform vec3 lightColor;
-uniform vec3 viewPos;
-uniform bool cameraLightEnabled;
+// Dados do frame (FrameUniforms, layout std140 espelhado em FrameData)
+layout (std140, binding = 1) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
+
+// Luzes da cena (FrameUniforms, layout std140 espelhado em LightData)
+layout (std140, binding = 2) uniform LightData {
+    vec3 lightPos1;
+    vec3 lightPos2;
+    vec3 lightPos3;     // luz da câmara
+    vec3 lightColor;
+};
+
+const vec3 FOG_COLOR = vec3(0.15, 0.20, 0.35); // horizonte do céu (Background)
+const float FOG_DENSITY = 0.03;
 
 vec3 calculateLight(vec3 lightPos, vec3 norm, vec3 viewDir, float intensity)
 {
@@ -43,7 +75,10 @@ vec3 calculateLight(vec3 lightPos, vec3 norm, vec3 viewDir, float intensity)
 
 void main()
 {
+    material = materials[MaterialIndex];
     
+    // a orientação é consistente (Mesh::repairWinding); as superfícies de
+    // dupla face, desenhadas sem culling, mostram o verso com a normal invertida
     vec3 norm = normalize(Normal);
     if (!gl_FrontFacing) {
         norm = -norm;
@@ -55,19 +90,30 @@ void main()
     // componente ambiente base (ligada ao material)
     vec3 ambient = material.ambient * 0.25;
 
+    vec3 result = ambient;
+
     // Luz 1 e 2 ambientes
-    vec3 light1 = calculateLight(lightPos1, norm, viewDir, 0.7) * lightColor;
-    vec3 light2 = calculateLight(lightPos2, norm, viewDir, 0.4) * lightColor;
+#if LIGHT_COUNT >= 1
+    result += calculateLight(lightPos1, norm, viewDir, 0.7) * lightColor;
+#endif
+#if LIGHT_COUNT >= 2
+    result += calculateLight(lightPos2, norm, viewDir, 0.4) * lightColor;
+#endif
 
     // Luz 3 (câmara - lanterna)
-    vec3 light3 = vec3(0.0);
-    if (cameraLightEnabled) {
-        light3 = calculateLight(lightPos3, norm, viewDir, 0.8) * lightColor * vec3(1.0, 0.95, 0.9);
-    }
-
-    vec3 result = ambient + light1 + light2 + light3;
+#if CAMERA_LIGHT
+    result += calculateLight(lightPos3, norm, viewDir, 0.8) * lightColor * vec3(1.0, 0.95, 0.9);
+#endif
 
     // gamma correction
+#if GAMMA
     result = pow(result, vec3(1.0/2.2));
+#endif
+
+    // o nevoeiro mistura já no espaço do ecrã, onde está a cor do céu
+#if FOG
+    float fogDistance = length(viewPos - FragPos) * FOG_DENSITY;
+    result = mix(FOG_COLOR, result, exp(-fogDistance * fogDistance));
+#endif
     FragColor = vec4(result, 1.0);
 }
@@ -3,8 +3,14 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Dados do frame (FrameUniforms, layout std140 espelhado em FrameData)
+layout (std140, binding = 1) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
 
 void main() {
     gl_Position = projection * view * model * vec4(aPos, 1.0);
@@ -2,17 +2,51 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
+layout (location = 2) in uint aDrawId; // instanciado, = baseInstance do comando
 
 out vec3 FragPos;
 out vec3 Normal;
+flat out uint MaterialIndex;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// Dados do frame (FrameUniforms, layout std140 espelhado em FrameData)
+layout (std140, binding = 1) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
+
+// Dados por draw (DrawData, ver IndirectDraw). Com vértices quantizados,
+// aPos está em [0,1] relativo à AABB do SubMesh e aNormal.xy tem a normal
+// octaédrica.
+struct DrawData {
+    vec4 positionOffset; // w = 1 se quantizado
+    vec4 positionScale;
+    uint materialIndex;
+};
+
+layout (std430, binding = 0) readonly buffer DrawBlock {
+    DrawData draws[];
+};
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    DrawData d = draws[aDrawId];
+    bool quantized = d.positionOffset.w > 0.5;
+    vec3 position = quantized ? d.positionOffset.xyz + aPos * d.positionScale.xyz : aPos;
+    vec3 normal = quantized ? octDecode(aNormal.xy) : aNormal;
+
+    FragPos = vec3(model * vec4(position, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normal;
+    MaterialIndex = d.materialIndex;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
-}
\ No newline at end of file
+}
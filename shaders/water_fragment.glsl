@@ -6,13 +6,39 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 WaterCoord;
 
-uniform vec3 lightPos1;
-uniform vec3 lightPos2;
-uniform vec3 lightPos3;
-uniform bool cameraLightEnabled;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
-uniform float time;
+// Funcionalidades fixadas na compilação (ShaderVariants injeta os #defines
+// a seguir ao #version); os valores abaixo valem sem defines
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 2   // luzes da cena (sol e preenchimento), sem a lanterna
+#endif
+#ifndef CAMERA_LIGHT
+#define CAMERA_LIGHT 1  // lanterna da câmara
+#endif
+#ifndef GAMMA
+#define GAMMA 1
+#endif
+#ifndef FOG
+#define FOG 0           // nevoeiro exponencial até à cor do horizonte
+#endif
+
+// Dados do frame (FrameUniforms, layout std140 espelhado em FrameData)
+layout (std140, binding = 1) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
+
+// Luzes da cena (FrameUniforms, layout std140 espelhado em LightData)
+layout (std140, binding = 2) uniform LightData {
+    vec3 lightPos1;
+    vec3 lightPos2;
+    vec3 lightPos3;     // luz da câmara
+    vec3 lightColor;
+};
+
+const vec3 FOG_COLOR = vec3(0.15, 0.20, 0.35); // horizonte do céu (Background)
+const float FOG_DENSITY = 0.03;
 
 vec3 calculateLight(vec3 lightPos, vec3 norm, vec3 viewDir, float intensity) {
     vec3 lightDir = normalize(lightPos - FragPos);
@@ -47,23 +73,32 @@ void main() {
     // Ambiente
     vec3 ambient = 0.3 * lightColor * waterColor;
     
-    // Luzes
-    vec3 light1 = calculateLight(lightPos1, norm, viewDir, 1.0) * lightColor;
-    vec3 light2 = calculateLight(lightPos2, norm, viewDir, 0.5) * lightColor;
-    
-    vec3 light3 = vec3(0.0);
-    if (cameraLightEnabled) {
-        light3 = calculateLight(lightPos3, norm, viewDir, 0.8) * lightColor;
-    }
-    
     // Reflexo do céu 
     float fresnel = pow(1.0 - max(dot(norm, viewDir), 0.0), 3.0);
     vec3 skyReflection = vec3(0.1, 0.15, 0.25) * fresnel;
-    
-    vec3 result = ambient + light1 + light2 + light3 + skyReflection;
+
+    vec3 result = ambient + skyReflection;
+
+    // Luzes
+#if LIGHT_COUNT >= 1
+    result += calculateLight(lightPos1, norm, viewDir, 1.0) * lightColor;
+#endif
+#if LIGHT_COUNT >= 2
+    result += calculateLight(lightPos2, norm, viewDir, 0.5) * lightColor;
+#endif
+#if CAMERA_LIGHT
+    result += calculateLight(lightPos3, norm, viewDir, 0.8) * lightColor;
+#endif
     
     // Gamma correction
+#if GAMMA
     result = pow(result, vec3(1.0/2.2));
+#endif
+
+#if FOG
+    float fogDistance = length(viewPos - FragPos) * FOG_DENSITY;
+    result = mix(FOG_COLOR, result, exp(-fogDistance * fogDistance));
+#endif
     
     // Transparência baseada no ângulo de visão
     float alpha = 0.85 + fresnel * 0.15;
@@ -8,9 +8,14 @@ out vec3 Normal;
 out vec2 WaterCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform float time;
+
+// Dados do frame (FrameUniforms, layout std140 espelhado em FrameData)
+layout (std140, binding = 1) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float time;
+};
 
 void main() {
     // Simulação de ondas com múltiplas frequências
@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <iostream>
 
+#include "frustum.h"
+
 class Background
 {
 public:
@@ -67,6 +69,10 @@ public:
     unsigned int VAO, VBO, EBO;
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
+    Bounds bounds;
+
+    // Amplitude máxima das ondas em water_vertex.glsl (0.08 + 0.06 + 0.04)
+    static constexpr float WAVE_AMPLITUDE = 0.18f;
 
     WaterPlane()
     {
@@ -141,6 +147,9 @@ public:
 
         glBindVertexArray(0);
 
+        bounds = Bounds::fromBox(glm::vec3(-size / 2.0f, -0.5f - WAVE_AMPLITUDE, -size / 2.0f),
+                                 glm::vec3(size / 2.0f, -0.5f + WAVE_AMPLITUDE, size / 2.0f));
+
         std::cout << "Water plane created with " << indices.size() / 3 << " triangles!" << std::endl;
     }
 
@@ -0,0 +1,97 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Dados comuns a todos os programas num frame: bloco uniforme FrameData
+// (std140, binding FrameUniforms::FRAME_BINDING) dos shaders
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+    float time;
+};
+
+// Luzes da cena: bloco uniforme LightData (std140, binding
+// FrameUniforms::LIGHT_BINDING). Cada vec3 ocupa 16 bytes. A lanterna não
+// tem flag: ligada ou não, é uma variante do shader (CAMERA_LIGHT).
+struct LightData
+{
+    glm::vec3 lightPos1;
+    float padding0;
+    glm::vec3 lightPos2;
+    float padding1;
+    glm::vec3 lightPos3; // luz da câmara
+    float padding2;
+    glm::vec3 lightColor;
+    float padding3;
+};
+
+static_assert(sizeof(FrameData) == 144, "FrameData deve seguir o layout std140 do shader");
+static_assert(offsetof(FrameData, view) == 0 && offsetof(FrameData, projection) == 64 &&
+                  offsetof(FrameData, viewPos) == 128 && offsetof(FrameData, time) == 140,
+              "FrameData não segue o layout std140");
+static_assert(sizeof(LightData) == 64, "LightData deve seguir o layout std140 do shader");
+static_assert(offsetof(LightData, lightPos1) == 0 && offsetof(LightData, lightPos2) == 16 &&
+                  offsetof(LightData, lightPos3) == 32 && offsetof(LightData, lightColor) == 48,
+              "LightData não segue o layout std140");
+
+// Os dois UBOs partilhados, enviados uma vez por frame (upload) antes de
+// qualquer draw; os programas só definem os uniforms por objeto (model...)
+class FrameUniforms
+{
+public:
+    // MaterialBlock usa o binding 0 (IndirectDraw::MATERIAL_BINDING)
+    static constexpr GLuint FRAME_BINDING = 1;
+    static constexpr GLuint LIGHT_BINDING = 2;
+
+    FrameUniforms()
+    {
+        glGenBuffers(1, &frameBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+
+        glGenBuffers(1, &lightBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, lightBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    FrameUniforms(const FrameUniforms &) = delete;
+    FrameUniforms &operator=(const FrameUniforms &) = delete;
+
+    ~FrameUniforms()
+    {
+        destroy();
+    }
+
+    // Chamar antes de glfwTerminate (o destrutor já não tem contexto)
+    void destroy()
+    {
+        if (!frameBuffer)
+            return;
+        glDeleteBuffers(1, &frameBuffer);
+        glDeleteBuffers(1, &lightBuffer);
+        frameBuffer = lightBuffer = 0;
+    }
+
+    void upload(const FrameData &frame, const LightData &lights)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frame);
+        glBindBuffer(GL_UNIFORM_BUFFER, lightBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightData), &lights);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, frameBuffer);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BINDING, lightBuffer);
+    }
+
+private:
+    unsigned int frameBuffer = 0, lightBuffer = 0;
+};
+
+#endif
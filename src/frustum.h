@@ -0,0 +1,94 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "mesh_types.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+// Seis planos (ax + by + cz + d >= 0 no interior) extraídos de uma matriz
+// de projeção (Gribb & Hartmann). Com projection * view * model os planos
+// ficam no espaço do modelo e os volumes não precisam de ser transformados.
+class Frustum
+{
+public:
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4 &m)
+    {
+        Frustum f;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                f.planes[i * 2][c] = m[c][3] + m[c][i];
+                f.planes[i * 2 + 1][c] = m[c][3] - m[c][i];
+            }
+        }
+        for (glm::vec4 &p : f.planes)
+        {
+            float length = glm::length(glm::vec3(p));
+            if (length > 0.0f)
+                p = p / length;
+        }
+        return f;
+    }
+
+    bool intersectsSphere(const glm::vec3 &center, float radius) const
+    {
+        for (const glm::vec4 &p : planes)
+            if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+                return false;
+        return true;
+    }
+
+    // Vértice positivo da caixa (o mais à frente segundo a normal de cada plano)
+    bool intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const
+    {
+        for (const glm::vec4 &p : planes)
+        {
+            glm::vec3 v(p.x >= 0.0f ? max.x : min.x, p.y >= 0.0f ? max.y : min.y, p.z >= 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(p), v) + p.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    bool intersects(const Bounds &b) const
+    {
+        return intersectsSphere(b.center, b.radius) && intersectsBox(b.min, b.max);
+    }
+
+    // Teste de várias esferas em SoA (quatro de cada vez com SSE); visible[i]
+    // fica a 1 se a esfera i interseta o frustum
+    void testSpheres(const float *x, const float *y, const float *z, const float *r,
+                     size_t count, unsigned char *visible) const
+    {
+        size_t i = 0;
+#ifdef FRUSTUM_SSE
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+            __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i));
+            __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+            for (const glm::vec4 &p : planes)
+            {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.x)), _mm_mul_ps(cy, _mm_set1_ps(p.y))),
+                                      _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+            }
+            int mask = _mm_movemask_ps(inside);
+            for (int k = 0; k < 4; ++k)
+                visible[i + k] = (mask >> k) & 1;
+        }
+#endif
+        for (; i < count; ++i)
+            visible[i] = intersectsSphere(glm::vec3(x[i], y[i], z[i]), r[i]) ? 1 : 0;
+    }
+};
+
+#endif
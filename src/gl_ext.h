@@ -0,0 +1,203 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+
+// O GLAD em libs/ foi gerado para GL 3.3; as funções e constantes mais
+// recentes que o projeto usa (o contexto é 4.3 core) são carregadas aqui,
+// com os mesmos nomes que teriam num GLAD gerado para 4.3.
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_UNIFORM
+#define GL_UNIFORM 0x92E1
+#endif
+#ifndef GL_ACTIVE_RESOURCES
+#define GL_ACTIVE_RESOURCES 0x92F5
+#endif
+#ifndef GL_MAX_NAME_LENGTH
+#define GL_MAX_NAME_LENGTH 0x92F6
+#endif
+#ifndef GL_TYPE
+#define GL_TYPE 0x92FA
+#endif
+#ifndef GL_ARRAY_SIZE
+#define GL_ARRAY_SIZE 0x92FB
+#endif
+#ifndef GL_BLOCK_INDEX
+#define GL_BLOCK_INDEX 0x92FD
+#endif
+#ifndef GL_LOCATION
+#define GL_LOCATION 0x930E
+#endif
+
+typedef void(APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)(GLenum mode, GLenum type, const void *indirect,
+                                                                GLsizei drawcount, GLsizei stride);
+
+inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT glext_glMultiDrawElementsIndirect = nullptr;
+
+#ifndef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect glext_glMultiDrawElementsIndirect
+#endif
+
+// GL 4.3: introspeção dos recursos de um programa (uniforms, blocos)
+typedef void(APIENTRYP PFNGLGETPROGRAMINTERFACEIVPROC_EXT)(GLuint program, GLenum programInterface,
+                                                           GLenum pname, GLint *params);
+typedef void(APIENTRYP PFNGLGETPROGRAMRESOURCEIVPROC_EXT)(GLuint program, GLenum programInterface, GLuint index,
+                                                          GLsizei propCount, const GLenum *props, GLsizei count,
+                                                          GLsizei *length, GLint *params);
+typedef void(APIENTRYP PFNGLGETPROGRAMRESOURCENAMEPROC_EXT)(GLuint program, GLenum programInterface, GLuint index,
+                                                            GLsizei bufSize, GLsizei *length, GLchar *name);
+
+inline PFNGLGETPROGRAMINTERFACEIVPROC_EXT glext_glGetProgramInterfaceiv = nullptr;
+inline PFNGLGETPROGRAMRESOURCEIVPROC_EXT glext_glGetProgramResourceiv = nullptr;
+inline PFNGLGETPROGRAMRESOURCENAMEPROC_EXT glext_glGetProgramResourceName = nullptr;
+
+#ifndef glGetProgramInterfaceiv
+#define glGetProgramInterfaceiv glext_glGetProgramInterfaceiv
+#endif
+#ifndef glGetProgramResourceiv
+#define glGetProgramResourceiv glext_glGetProgramResourceiv
+#endif
+#ifndef glGetProgramResourceName
+#define glGetProgramResourceName glext_glGetProgramResourceName
+#endif
+
+// GL 4.1 / ARB_get_program_binary (opcional: cache de programas em disco)
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC_EXT)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                                       GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC_EXT)(GLuint program, GLenum binaryFormat, const void *binary,
+                                                    GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC_EXT)(GLuint program, GLenum pname, GLint value);
+
+inline PFNGLGETPROGRAMBINARYPROC_EXT glext_glGetProgramBinary = nullptr;
+inline PFNGLPROGRAMBINARYPROC_EXT glext_glProgramBinary = nullptr;
+inline PFNGLPROGRAMPARAMETERIPROC_EXT glext_glProgramParameteri = nullptr;
+inline bool glext_ARB_get_program_binary = false;
+
+#ifndef glGetProgramBinary
+#define glGetProgramBinary glext_glGetProgramBinary
+#endif
+#ifndef glProgramBinary
+#define glProgramBinary glext_glProgramBinary
+#endif
+#ifndef glProgramParameteri
+#define glProgramParameteri glext_glProgramParameteri
+#endif
+
+// KHR_parallel_shader_compile (opcional: compilação em threads do driver,
+// com o fim consultado por GL_COMPLETION_STATUS_KHR sem bloquear)
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_EXT)(GLuint count);
+
+inline PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_EXT glext_glMaxShaderCompilerThreadsKHR = nullptr;
+inline bool glext_KHR_parallel_shader_compile = false;
+
+#ifndef glMaxShaderCompilerThreadsKHR
+#define glMaxShaderCompilerThreadsKHR glext_glMaxShaderCompilerThreadsKHR
+#endif
+
+// GL 4.4 / ARB_buffer_storage (opcional: buffers com mapeamento persistente)
+typedef void(APIENTRYP PFNGLBUFFERSTORAGEPROC_EXT)(GLenum target, GLsizeiptr size, const void *data,
+                                                    GLbitfield flags);
+
+inline PFNGLBUFFERSTORAGEPROC_EXT glext_glBufferStorage = nullptr;
+inline bool glext_ARB_buffer_storage = false;
+
+#ifndef glBufferStorage
+#define glBufferStorage glext_glBufferStorage
+#endif
+
+inline bool hasGLExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Chamar depois de gladLoadGLLoader; devolve false se faltar alguma função
+// obrigatória
+inline bool loadGLExtensions(GLADloadproc load)
+{
+    glext_glMultiDrawElementsIndirect =
+        (PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)load("glMultiDrawElementsIndirect");
+    glext_glGetProgramInterfaceiv = (PFNGLGETPROGRAMINTERFACEIVPROC_EXT)load("glGetProgramInterfaceiv");
+    glext_glGetProgramResourceiv = (PFNGLGETPROGRAMRESOURCEIVPROC_EXT)load("glGetProgramResourceiv");
+    glext_glGetProgramResourceName = (PFNGLGETPROGRAMRESOURCENAMEPROC_EXT)load("glGetProgramResourceName");
+
+    if (!glext_glMultiDrawElementsIndirect)
+    {
+        std::cout << "ERROR: glMultiDrawElementsIndirect not available (OpenGL 4.3 required)" << std::endl;
+        return false;
+    }
+    if (!glext_glGetProgramInterfaceiv || !glext_glGetProgramResourceiv || !glext_glGetProgramResourceName)
+    {
+        std::cout << "ERROR: program interface queries not available (OpenGL 4.3 required)" << std::endl;
+        return false;
+    }
+
+    // no contexto 4.3 só existe através da extensão
+    if (hasGLExtension("GL_ARB_buffer_storage"))
+        glext_glBufferStorage = (PFNGLBUFFERSTORAGEPROC_EXT)load("glBufferStorage");
+    glext_ARB_buffer_storage = glext_glBufferStorage != nullptr;
+
+    // sem nenhum formato binário o driver não guarda programas
+    glext_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC_EXT)load("glGetProgramBinary");
+    glext_glProgramBinary = (PFNGLPROGRAMBINARYPROC_EXT)load("glProgramBinary");
+    glext_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC_EXT)load("glProgramParameteri");
+    GLint binaryFormats = 0;
+    if (glext_glGetProgramBinary && glext_glProgramBinary && glext_glProgramParameteri)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    glext_ARB_get_program_binary = binaryFormats > 0;
+
+    // a versão ARB tem a mesma semântica e o mesmo enum; 0xFFFFFFFF deixa o
+    // driver usar quantas threads quiser
+    if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+        glext_glMaxShaderCompilerThreadsKHR =
+            (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_EXT)load("glMaxShaderCompilerThreadsKHR");
+    else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+        glext_glMaxShaderCompilerThreadsKHR =
+            (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC_EXT)load("glMaxShaderCompilerThreadsARB");
+    glext_KHR_parallel_shader_compile = glext_glMaxShaderCompilerThreadsKHR != nullptr;
+    if (glext_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    return true;
+}
+
+#endif
@@ -0,0 +1,458 @@
+#ifndef GLTF_LOADER_H
+#define GLTF_LOADER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "mapped_file.h"
+#include "mesh_types.h"
+#include "normal_generator.h"
+
+// Uma primitiva de triângulos de um nó, já no espaço da cena. vertices e
+// indices ficam sempre preenchidos (bounds, BVH, meshlets); mappedVertices
+// e mappedIndices apontam para o chunk BIN do ficheiro mapeado quando o
+// layout lá é exatamente o de Vertex / unsigned int e o nó não tem
+// transformação, para o upload ir direto do ficheiro para a GPU.
+struct GltfPrimitive
+{
+    bool hasMaterial = false;
+    Material material;
+    bool doubleSided = false;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    const Vertex *mappedVertices = nullptr;
+    const unsigned int *mappedIndices = nullptr;
+};
+
+struct GltfData
+{
+    std::vector<GltfPrimitive> primitives;
+    size_t skippedPrimitives = 0; // não triangulares ou com dados inválidos
+};
+
+// Leitor de glTF 2.0 binário (.glb): cabeçalho JSON mais um chunk BIN, lido
+// a partir do MappedFile sem cópia. Suporta POSITION/NORMAL em float,
+// índices de 8/16/32 bits e a hierarquia de nós da cena; buffers externos
+// (uri), accessors esparsos e texturas não são suportados. Os materiais PBR
+// (metallic-roughness) são convertidos para o Material de Phong.
+class GltfLoader
+{
+public:
+    // Os ponteiros mapped* ficam válidos enquanto file estiver aberto
+    static bool parse(const MappedFile &file, GltfData &out, std::string &error)
+    {
+        out = GltfData();
+        const char *bin = nullptr;
+        size_t binSize = 0;
+        JsonValue json;
+        if (!readChunks(file, json, bin, binSize, error))
+            return false;
+
+        Context ctx{json, bin, binSize, out};
+        std::vector<Material> materials;
+        std::vector<bool> doubleSided;
+        const JsonValue &jsonMaterials = json["materials"];
+        for (size_t i = 0; i < jsonMaterials.size(); ++i)
+        {
+            materials.push_back(convertMaterial(jsonMaterials[i], i));
+            doubleSided.push_back(jsonMaterials[i]["doubleSided"].boolean(false));
+        }
+        ctx.materials = &materials;
+        ctx.doubleSided = &doubleSided;
+        ctx.visited.assign(json["nodes"].size(), false);
+
+        // Nós da cena (ou de scenes[0]); sem cenas, todos os meshes na origem
+        const JsonValue &scenes = json["scenes"];
+        long sceneIndex = json["scene"].index();
+        const JsonValue &scene = scenes[sceneIndex >= 0 ? (size_t)sceneIndex : 0];
+        if (scene.isObject())
+        {
+            const JsonValue &roots = scene["nodes"];
+            for (size_t i = 0; i < roots.size(); ++i)
+                addNode(ctx, roots[i].index(), glm::mat4(1.0f), 0);
+        }
+        else
+        {
+            for (size_t m = 0; m < json["meshes"].size(); ++m)
+                addMesh(ctx, (long)m, glm::mat4(1.0f));
+        }
+        return true;
+    }
+
+private:
+    // Tipos de componente e modo de desenho do glTF (= enums de GL)
+    static constexpr long UNSIGNED_BYTE = 5121;
+    static constexpr long UNSIGNED_SHORT = 5123;
+    static constexpr long UNSIGNED_INT = 5125;
+    static constexpr long FLOAT = 5126;
+    static constexpr long TRIANGLES = 4;
+    static constexpr int MAX_NODE_DEPTH = 64;
+
+    struct Context
+    {
+        const JsonValue &json;
+        const char *bin;
+        size_t binSize;
+        GltfData &out;
+        const std::vector<Material> *materials = nullptr;
+        const std::vector<bool> *doubleSided = nullptr;
+        std::vector<bool> visited; // nós já adicionados (a hierarquia é uma árvore)
+    };
+
+    // Vista de um accessor sobre o chunk BIN
+    struct AccessorView
+    {
+        const char *data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        long componentType = 0;
+        long bufferView = -1;
+        size_t components = 0;
+    };
+
+    static uint32_t readU32(const char *p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+
+    static bool readChunks(const MappedFile &file, JsonValue &json, const char *&bin, size_t &binSize,
+                           std::string &error)
+    {
+        const char *data = file.data();
+        size_t size = file.size();
+        if (!file.isOpen() || size < 20 || std::memcmp(data, "glTF", 4) != 0)
+        {
+            error = "not a binary glTF file";
+            return false;
+        }
+        if (readU32(data + 4) != 2)
+        {
+            error = "unsupported glTF version " + std::to_string(readU32(data + 4));
+            return false;
+        }
+        size = std::min<size_t>(size, readU32(data + 8));
+
+        size_t offset = 12;
+        bool haveJson = false;
+        while (offset + 8 <= size)
+        {
+            size_t chunkLength = readU32(data + offset);
+            uint32_t chunkType = readU32(data + offset + 4);
+            const char *chunk = data + offset + 8;
+            if (chunkLength > size - offset - 8)
+            {
+                error = "truncated chunk";
+                return false;
+            }
+
+            if (chunkType == 0x4E4F534A) // "JSON"
+            {
+                if (!JsonValue::parse(chunk, chunk + chunkLength, json))
+                {
+                    error = "invalid JSON chunk";
+                    return false;
+                }
+                haveJson = true;
+            }
+            else if (chunkType == 0x004E4942 && !bin) // "BIN\0"
+            {
+                bin = chunk;
+                binSize = chunkLength;
+            }
+            offset += 8 + ((chunkLength + 3) & ~size_t(3));
+        }
+        if (!haveJson)
+            error = "missing JSON chunk";
+        return haveJson;
+    }
+
+    // Phong a partir de metallic-roughness: o difuso perde a cor base nos
+    // metais, o especular vai de 4% (dielétrico) à cor base (metal) e o
+    // expoente segue a conversão habitual de Blinn-Phong (a = roughness^2,
+    // n = 2/a^2 - 2), dividido por 4 para o reflexo de Phong do shader
+    static Material convertMaterial(const JsonValue &m, size_t index)
+    {
+        const JsonValue &pbr = m["pbrMetallicRoughness"];
+        const JsonValue &factor = pbr["baseColorFactor"];
+        glm::vec3 base(factor[0].number(1.0), factor[1].number(1.0), factor[2].number(1.0));
+        float metallic = (float)pbr["metallicFactor"].number(1.0);
+        float roughness = std::max(0.05f, (float)pbr["roughnessFactor"].number(1.0));
+
+        Material material;
+        material.name = m["name"].isString() ? m["name"].string() : "material_" + std::to_string(index);
+        material.ambient = base;
+        material.diffuse = base * (1.0f - metallic);
+        material.specular = glm::vec3(0.04f) * (1.0f - metallic) + base * metallic;
+        float alpha = roughness * roughness;
+        material.shininess = std::min(256.0f, std::max(1.0f, (2.0f / (alpha * alpha) - 2.0f) * 0.25f));
+        return material;
+    }
+
+    static glm::mat4 nodeMatrix(const JsonValue &node)
+    {
+        const JsonValue &matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            glm::mat4 m;
+            for (int c = 0; c < 4; ++c)
+                for (int r = 0; r < 4; ++r)
+                    m[c][r] = (float)matrix[c * 4 + r].number(); // coluna a coluna, como GL
+            return m;
+        }
+
+        const JsonValue &t = node["translation"], &r = node["rotation"], &s = node["scale"];
+        float qx = (float)r[0].number(0.0), qy = (float)r[1].number(0.0);
+        float qz = (float)r[2].number(0.0), qw = (float)r[3].number(1.0);
+        glm::vec3 scale(s[0].number(1.0), s[1].number(1.0), s[2].number(1.0));
+
+        glm::mat4 m(1.0f);
+        m[0] = glm::vec4(1 - 2 * (qy * qy + qz * qz), 2 * (qx * qy + qz * qw), 2 * (qx * qz - qy * qw), 0) * scale.x;
+        m[1] = glm::vec4(2 * (qx * qy - qz * qw), 1 - 2 * (qx * qx + qz * qz), 2 * (qy * qz + qx * qw), 0) * scale.y;
+        m[2] = glm::vec4(2 * (qx * qz + qy * qw), 2 * (qy * qz - qx * qw), 1 - 2 * (qx * qx + qy * qy), 0) * scale.z;
+        m[3] = glm::vec4((float)t[0].number(0.0), (float)t[1].number(0.0), (float)t[2].number(0.0), 1.0f);
+        return m;
+    }
+
+    static void addNode(Context &ctx, long index, const glm::mat4 &parent, int depth)
+    {
+        const JsonValue &node = ctx.json["nodes"][index >= 0 ? (size_t)index : SIZE_MAX];
+        if (!node.isObject() || depth > MAX_NODE_DEPTH)
+            return;
+        // Um nó alcançado duas vezes (filho repetido, dois pais ou ciclo)
+        // não é válido em glTF: ignora-se, senão as primitivas duplicavam
+        // e "children":[0,0] multiplicava as chamadas a cada nível
+        if (ctx.visited[(size_t)index])
+            return;
+        ctx.visited[(size_t)index] = true;
+
+        glm::mat4 world = parent * nodeMatrix(node);
+        if (node.has("mesh"))
+            addMesh(ctx, node["mesh"].index(), world);
+        const JsonValue &children = node["children"];
+        for (size_t i = 0; i < children.size(); ++i)
+            addNode(ctx, children[i].index(), world, depth + 1);
+    }
+
+    static bool isIdentity(const glm::mat4 &m)
+    {
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                if (m[c][r] != (c == r ? 1.0f : 0.0f))
+                    return false;
+        return true;
+    }
+
+    static size_t componentSize(long type)
+    {
+        switch (type)
+        {
+        case UNSIGNED_BYTE:
+            return 1;
+        case UNSIGNED_SHORT:
+            return 2;
+        case UNSIGNED_INT:
+        case FLOAT:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    static size_t componentCount(const std::string &type)
+    {
+        if (type == "SCALAR")
+            return 1;
+        if (type == "VEC2")
+            return 2;
+        if (type == "VEC3")
+            return 3;
+        if (type == "VEC4")
+            return 4;
+        return 0;
+    }
+
+    // Inteiro >= 0 e <= limit (contagens, offsets, tamanhos); um campo em
+    // falta vale 0. Recusa NaN, infinitos, negativos e frações antes de
+    // converter, porque o cast de um double fora do alcance não é definido
+    static bool unsignedValue(const JsonValue &v, size_t limit, size_t &out)
+    {
+        double d = v.number(0.0);
+        if (!(d >= 0.0 && d <= (double)limit) || d != std::floor(d))
+            return false;
+        out = (size_t)d;
+        return true;
+    }
+
+    // Valida o accessor contra o bufferView e o chunk BIN
+    static bool accessor(const Context &ctx, long index, AccessorView &view)
+    {
+        const JsonValue &a = ctx.json["accessors"][index >= 0 ? (size_t)index : SIZE_MAX];
+        if (!a.isObject() || a.has("sparse") || !ctx.bin)
+            return false;
+        view.bufferView = a["bufferView"].index();
+        const JsonValue &bv = ctx.json["bufferViews"][view.bufferView >= 0 ? (size_t)view.bufferView : SIZE_MAX];
+        if (!bv.isObject() || bv["buffer"].index() != 0)
+            return false;
+
+        view.componentType = a["componentType"].index();
+        view.components = componentCount(a["type"].string());
+        size_t elementSize = componentSize(view.componentType) * view.components;
+        if (elementSize == 0)
+            return false;
+
+        // todos os valores ficam limitados ao chunk BIN, por isso as somas
+        // abaixo não dão a volta
+        size_t viewOffset, viewLength, offset;
+        if (!unsignedValue(a["count"], ctx.binSize, view.count) ||
+            !unsignedValue(bv["byteStride"], ctx.binSize, view.stride) ||
+            !unsignedValue(bv["byteOffset"], ctx.binSize, viewOffset) ||
+            !unsignedValue(bv["byteLength"], ctx.binSize, viewLength) ||
+            !unsignedValue(a["byteOffset"], ctx.binSize, offset))
+            return false;
+        if (view.stride == 0)
+            view.stride = elementSize;
+        if (viewLength > ctx.binSize - viewOffset || view.stride < elementSize)
+            return false;
+        // o último elemento começa em (count - 1) * stride; compara por
+        // divisão para não multiplicar um count arbitrário
+        if (view.count > 0 && (offset > viewLength || elementSize > viewLength - offset ||
+                               view.count - 1 > (viewLength - offset - elementSize) / view.stride))
+            return false;
+
+        view.data = ctx.bin + viewOffset + offset;
+        return true;
+    }
+
+    static void addMesh(Context &ctx, long meshIndex, const glm::mat4 &world)
+    {
+        const JsonValue &mesh = ctx.json["meshes"][meshIndex >= 0 ? (size_t)meshIndex : SIZE_MAX];
+        const JsonValue &primitives = mesh["primitives"];
+        for (size_t i = 0; i < primitives.size(); ++i)
+        {
+            GltfPrimitive primitive;
+            if (addPrimitive(ctx, primitives[i], world, primitive))
+                ctx.out.primitives.push_back(std::move(primitive));
+            else
+                ctx.out.skippedPrimitives++;
+        }
+    }
+
+    static bool addPrimitive(const Context &ctx, const JsonValue &p, const glm::mat4 &world, GltfPrimitive &out)
+    {
+        if (p["mode"].number((double)TRIANGLES) != (double)TRIANGLES)
+            return false;
+
+        const JsonValue &attributes = p["attributes"];
+        AccessorView positions, normals;
+        if (!accessor(ctx, attributes["POSITION"].index(), positions) ||
+            positions.componentType != FLOAT || positions.components != 3)
+            return false;
+        bool hasNormals = attributes.has("NORMAL");
+        if (hasNormals && (!accessor(ctx, attributes["NORMAL"].index(), normals) ||
+                           normals.componentType != FLOAT || normals.components != 3 ||
+                           normals.count != positions.count))
+            return false;
+
+        // Índices (sem accessor: triângulos seguidos)
+        AccessorView indices;
+        bool indexed = p.has("indices");
+        if (indexed && (!accessor(ctx, p["indices"].index(), indices) || indices.components != 1 ||
+                        indices.componentType == FLOAT))
+            return false;
+        size_t indexCount = indexed ? indices.count / 3 * 3 : positions.count / 3 * 3;
+        out.indices.resize(indexCount);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            unsigned int index = (unsigned int)i;
+            if (indexed)
+            {
+                const char *src = indices.data + i * indices.stride;
+                if (indices.componentType == UNSIGNED_BYTE)
+                    index = static_cast<unsigned char>(*src);
+                else if (indices.componentType == UNSIGNED_SHORT)
+                {
+                    uint16_t v;
+                    std::memcpy(&v, src, 2);
+                    index = v;
+                }
+                else
+                    std::memcpy(&index, src, 4);
+            }
+            if (index >= positions.count)
+                return false;
+            out.indices[i] = index;
+        }
+
+        // Vértices no espaço da cena; normais pela inversa transposta
+        bool identity = isIdentity(world);
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+        out.vertices.resize(positions.count);
+        for (size_t v = 0; v < positions.count; ++v)
+        {
+            glm::vec3 position;
+            std::memcpy(&position, positions.data + v * positions.stride, sizeof(glm::vec3));
+            out.vertices[v].Position = identity ? position : glm::vec3(world * glm::vec4(position, 1.0f));
+            if (hasNormals)
+            {
+                glm::vec3 normal;
+                std::memcpy(&normal, normals.data + v * normals.stride, sizeof(glm::vec3));
+                if (!identity)
+                {
+                    normal = normalMatrix * normal;
+                    float length = glm::length(normal);
+                    normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+                }
+                out.vertices[v].Normal = normal;
+            }
+        }
+
+        // Transformação que espelha: a ordem dos cantos inverte-se
+        glm::vec3 x(world[0]), y(world[1]), z(world[2]);
+        bool mirrored = glm::dot(x, glm::cross(y, z)) < 0.0f;
+        if (mirrored)
+            for (size_t i = 0; i < indexCount; i += 3)
+                std::swap(out.indices[i + 1], out.indices[i + 2]);
+
+        if (!hasNormals)
+        {
+            std::vector<glm::vec3> points(positions.count), generated;
+            for (size_t v = 0; v < positions.count; ++v)
+                points[v] = out.vertices[v].Position;
+            std::vector<unsigned int> faces(out.indices.size());
+            for (size_t i = 0; i < faces.size(); ++i)
+                faces[i] = out.indices[i] + 1; // NormalGenerator usa índices 1-based
+            NormalGenerator::computeSmooth(points, {&faces}, generated);
+            for (size_t v = 0; v < positions.count; ++v)
+                out.vertices[v].Normal = generated[v];
+        }
+
+        // Zero-copy: POSITION e NORMAL intercalados como em Vertex no mesmo
+        // bufferView e índices de 32 bits contíguos
+        if (identity && hasNormals && positions.bufferView == normals.bufferView &&
+            positions.stride == sizeof(Vertex) && normals.data == positions.data + offsetof(Vertex, Normal) &&
+            reinterpret_cast<uintptr_t>(positions.data) % alignof(Vertex) == 0)
+            out.mappedVertices = reinterpret_cast<const Vertex *>(positions.data);
+        if (indexed && !mirrored && indices.componentType == UNSIGNED_INT && indices.stride == sizeof(unsigned int) &&
+            reinterpret_cast<uintptr_t>(indices.data) % alignof(unsigned int) == 0)
+            out.mappedIndices = reinterpret_cast<const unsigned int *>(indices.data);
+
+        long material = p["material"].index();
+        if (material >= 0 && (size_t)material < ctx.materials->size())
+        {
+            out.hasMaterial = true;
+            out.material = (*ctx.materials)[material];
+            out.doubleSided = (*ctx.doubleSided)[material];
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef HLOD_FILE_H
+#define HLOD_FILE_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_optimizer.h"
+#include "mesh_simplify.h"
+#include "mesh_types.h"
+#include "vertex_quantizer.h"
+
+// Hierarquia de clusters em disco (.boathlod) para modelos maiores do que a
+// memória (ver StreamingMesh). Cada SubMesh dá uma árvore binária: as folhas
+// são grupos espacialmente coerentes de até LEAF_TRIANGLES triângulos do
+// LOD 0 (divisão pela mediana dos centróides no eixo mais comprido) e cada
+// nó interior é a união dos dois filhos simplificada para metade. A
+// fronteira de um nó fica fixa ao simplificar (MeshSimplifier), por isso
+// nós vizinhos de níveis diferentes encaixam sem fendas; para isso também
+// todos os nós de uma árvore são quantizados na mesma grelha (a AABB da
+// árvore), e um vértice da fronteira desquantiza para o mesmo ponto em
+// qualquer dos nós que o têm.
+//
+// Layout (little-endian, offsets absolutos alinhados a 16 bytes):
+//   Header | por nó: PackedVertex[vertexCount] + uint32 índices[indexCount] |
+//   TreeRecord[treeCount] | NodeRecord[nodeCount]
+// As tabelas (pequenas) são lidas ao abrir; a geometria de cada nó só
+// quando é precisa.
+class HlodFile
+{
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t LEAF_TRIANGLES = 8192;
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFFu;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t treeCount;
+        uint32_t nodeCount;
+        uint32_t vertexSize;
+        uint64_t treeOffset;
+        uint64_t nodeOffset;
+        uint64_t reserved;
+    };
+
+    // Uma árvore por SubMesh de origem, com o respetivo material
+    struct TreeRecord
+    {
+        float ambient[3];
+        float diffuse[3];
+        float specular[3];
+        float shininess;
+        uint32_t root;
+        uint32_t flags;
+    };
+
+    static constexpr uint32_t FLAG_CULL_BACK_FACES = 1;
+
+    struct NodeRecord
+    {
+        float boundsMin[3];
+        float radius; // esfera centrada na AABB
+        float boundsMax[3];
+        float error; // desvio máximo em relação ao LOD 0 (unidades do modelo), nunca menor que o dos filhos
+        float positionOffset[3];
+        uint32_t tree;
+        float positionScale[3];
+        uint32_t parent;
+        uint32_t children[2]; // NO_NODE nas folhas
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint64_t dataOffset;
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 48, "Header do .boathlod mudou de tamanho");
+    static_assert(sizeof(TreeRecord) == 48, "TreeRecord do .boathlod mudou de tamanho");
+    static_assert(sizeof(NodeRecord) == 96, "NodeRecord do .boathlod mudou de tamanho");
+
+    static std::string hlodPath(const std::string &objPath)
+    {
+        return objPath.substr(0, objPath.find_last_of('.')) + ".boathlod";
+    }
+
+    static bool isLeaf(const NodeRecord &node) { return node.children[0] == NO_NODE; }
+
+    // Bytes da geometria de um nó no ficheiro (vértices seguidos dos índices)
+    static uint64_t dataSize(const NodeRecord &node)
+    {
+        return uint64_t(node.vertexCount) * sizeof(PackedVertex) + uint64_t(node.indexCount) * sizeof(unsigned int);
+    }
+
+    // Lê e valida o cabeçalho e as tabelas (sem a geometria)
+    static bool readIndex(const std::string &path, std::vector<TreeRecord> &trees, std::vector<NodeRecord> &nodes)
+    {
+        trees.clear();
+        nodes.clear();
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+        file.seekg(0, std::ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
+
+        Header header;
+        if (fileSize < sizeof(Header) || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            return false;
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.vertexSize != sizeof(PackedVertex) || header.treeCount == 0 ||
+            header.treeCount > fileSize / sizeof(TreeRecord) || header.nodeCount > fileSize / sizeof(NodeRecord) ||
+            !inBounds(fileSize, header.treeOffset, uint64_t(header.treeCount) * sizeof(TreeRecord)) ||
+            !inBounds(fileSize, header.nodeOffset, uint64_t(header.nodeCount) * sizeof(NodeRecord)))
+            return false;
+
+        trees.resize(header.treeCount);
+        nodes.resize(header.nodeCount);
+        file.seekg(static_cast<std::streamoff>(header.treeOffset));
+        file.read(reinterpret_cast<char *>(trees.data()), trees.size() * sizeof(TreeRecord));
+        file.seekg(static_cast<std::streamoff>(header.nodeOffset));
+        file.read(reinterpret_cast<char *>(nodes.data()), nodes.size() * sizeof(NodeRecord));
+        if (!file)
+            return false;
+
+        for (const TreeRecord &tree : trees)
+            if (tree.root >= nodes.size() || nodes[tree.root].parent != NO_NODE)
+                return false;
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const NodeRecord &node = nodes[i];
+            if (node.tree >= trees.size() || node.indexCount % 3 != 0 ||
+                !inBounds(fileSize, node.dataOffset, dataSize(node)))
+                return false;
+            if ((node.children[0] == NO_NODE) != (node.children[1] == NO_NODE))
+                return false;
+            for (uint32_t child : node.children)
+                if (child != NO_NODE && (child >= nodes.size() || nodes[child].parent != i))
+                    return false;
+        }
+        return true;
+    }
+
+    // Geometria de um nó (PackedVertex[] seguido de uint32 índices[])
+    static bool readNode(std::ifstream &file, const NodeRecord &node, std::vector<char> &out)
+    {
+        out.resize(static_cast<size_t>(dataSize(node)));
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(node.dataOffset));
+        return static_cast<bool>(file.read(out.data(), static_cast<std::streamsize>(out.size())));
+    }
+
+    // Constrói a hierarquia a partir do LOD 0 dos SubMeshes. A construção é
+    // em profundidade e a geometria de cada nó vai para o disco logo que
+    // fica pronta, por isso além da fonte só é preciso guardar em memória
+    // os nós de um caminho raiz-folha. Escreve para um ficheiro temporário
+    // e renomeia.
+    static bool build(const std::vector<SubMesh> &submeshes, const std::string &path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::string tmpPath = path + ".tmp";
+        bool ok;
+        Builder builder;
+        {
+            builder.file.open(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!builder.file.is_open())
+                return false;
+
+            // o cabeçalho só fica completo no fim
+            Header header = {};
+            builder.file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            for (const SubMesh &submesh : submeshes)
+            {
+                size_t triangleCount = submesh.indices.size() / 3;
+                if (triangleCount == 0)
+                    continue;
+
+                builder.remap.assign(submesh.vertices.size(), NO_NODE);
+                Bounds treeBounds = Bounds::fromVertices(submesh.vertices);
+                builder.quantization = VertexQuantizer::paramsFor(treeBounds.min, treeBounds.max);
+                std::vector<unsigned int> triangles(triangleCount);
+                for (size_t t = 0; t < triangleCount; ++t)
+                    triangles[t] = static_cast<unsigned int>(t);
+
+                uint32_t treeIndex = static_cast<uint32_t>(builder.trees.size());
+                builder.sourceTriangles += triangleCount;
+                NodeGeometry root = buildNode(builder, submesh, treeIndex, triangles.data(), triangleCount, 0);
+
+                TreeRecord tree = {};
+                const Material &m = submesh.material;
+                std::memcpy(tree.ambient, &m.ambient[0], sizeof(tree.ambient));
+                std::memcpy(tree.diffuse, &m.diffuse[0], sizeof(tree.diffuse));
+                std::memcpy(tree.specular, &m.specular[0], sizeof(tree.specular));
+                tree.shininess = m.shininess;
+                tree.root = root.id;
+                tree.flags = submesh.cullBackFaces ? FLAG_CULL_BACK_FACES : 0;
+                builder.trees.push_back(tree);
+            }
+
+            std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.version = VERSION;
+            header.treeCount = static_cast<uint32_t>(builder.trees.size());
+            header.nodeCount = static_cast<uint32_t>(builder.nodes.size());
+            header.vertexSize = sizeof(PackedVertex);
+            header.treeOffset = align(builder.offset);
+            header.nodeOffset = align(header.treeOffset + builder.trees.size() * sizeof(TreeRecord));
+
+            pad(builder.file, header.treeOffset);
+            builder.file.write(reinterpret_cast<const char *>(builder.trees.data()), builder.trees.size() * sizeof(TreeRecord));
+            pad(builder.file, header.nodeOffset);
+            builder.file.write(reinterpret_cast<const char *>(builder.nodes.data()), builder.nodes.size() * sizeof(NodeRecord));
+            builder.file.seekp(0);
+            builder.file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            ok = builder.file.good() && !builder.trees.empty();
+            builder.file.close();
+        }
+
+        std::error_code ec;
+        if (ok)
+            std::filesystem::rename(tmpPath, path, ec);
+        if (!ok || ec)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(tmpPath, ignored);
+            return false;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Built HLOD " << path << ": " << builder.trees.size() << " trees, " << builder.nodes.size()
+                  << " nodes (depth " << builder.maxDepth << "), " << builder.sourceTriangles << " triangles, "
+                  << std::fixed << std::setprecision(2) << builder.offset / (1024.0 * 1024.0) << " MB in "
+                  << elapsed.count() << " s" << std::defaultfloat << std::endl;
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'B', 'O', 'A', 'T', 'H', 'L', 'O', 'D'};
+
+    struct Builder
+    {
+        std::ofstream file;
+        uint64_t offset = sizeof(Header);
+        std::vector<TreeRecord> trees;
+        std::vector<NodeRecord> nodes;
+        std::vector<unsigned int> remap; // vértice do SubMesh -> vértice da folha em construção
+        QuantizationInfo quantization;   // grelha da árvore em construção
+        size_t sourceTriangles = 0;
+        unsigned int maxDepth = 0;
+    };
+
+    // Geometria de um nó enquanto o pai ainda não foi construído
+    struct NodeGeometry
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        glm::vec3 min, max; // AABB da região (contém a dos filhos)
+        float error;        // geométrico, sem a quantização
+        float recordError;  // o que ficou no NodeRecord
+        uint32_t id;
+    };
+
+    // Vértice comparado bit a bit (posição e normal), para soldar os
+    // vértices que os filhos partilham
+    struct VertexKey
+    {
+        PositionKey position, normal;
+
+        explicit VertexKey(const Vertex &v) : position(v.Position), normal(v.Normal) {}
+
+        bool operator==(const VertexKey &o) const { return position == o.position && normal == o.normal; }
+    };
+
+    struct VertexHash
+    {
+        size_t operator()(const VertexKey &k) const
+        {
+            PositionHash hash;
+            return hash(k.position) ^ (hash(k.normal) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    static NodeGeometry buildNode(Builder &builder, const SubMesh &submesh, uint32_t tree,
+                                  unsigned int *triangles, size_t count, unsigned int depth)
+    {
+        builder.maxDepth = std::max(builder.maxDepth, depth);
+        NodeGeometry node;
+        uint32_t children[2] = {NO_NODE, NO_NODE};
+        float childError = 0.0f;
+
+        if (count <= LEAF_TRIANGLES)
+        {
+            gatherLeaf(builder, submesh, triangles, count, node);
+            node.error = 0.0f;
+        }
+        else
+        {
+            // Mediana dos centróides (soma dos três vértices) no eixo mais
+            // comprido da caixa dos centróides
+            const std::vector<Vertex> &vertices = submesh.vertices;
+            const std::vector<unsigned int> &indices = submesh.indices;
+            auto centroid = [&](unsigned int t)
+            {
+                return vertices[indices[t * 3]].Position + vertices[indices[t * 3 + 1]].Position +
+                       vertices[indices[t * 3 + 2]].Position;
+            };
+            glm::vec3 minC(std::numeric_limits<float>::max()), maxC(-std::numeric_limits<float>::max());
+            for (size_t i = 0; i < count; ++i)
+            {
+                glm::vec3 c = centroid(triangles[i]);
+                minC = glm::min(minC, c);
+                maxC = glm::max(maxC, c);
+            }
+            glm::vec3 extent = maxC - minC;
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            size_t half = count / 2;
+            std::nth_element(triangles, triangles + half, triangles + count,
+                             [&](unsigned int a, unsigned int b) { return centroid(a)[axis] < centroid(b)[axis]; });
+
+            NodeGeometry left = buildNode(builder, submesh, tree, triangles, half, depth + 1);
+            NodeGeometry right = buildNode(builder, submesh, tree, triangles + half, count - half, depth + 1);
+            children[0] = left.id;
+            children[1] = right.id;
+            childError = std::max(left.recordError, right.recordError);
+
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+            mergeChildren(left, right, node);
+            float geometricError = std::max(left.error, right.error);
+            left = NodeGeometry();
+            right = NodeGeometry();
+
+            // Metade dos triângulos; a fronteira da região fica fixa, por
+            // isso nos níveis de cima o alvo pode não ser atingido
+            size_t target = std::min<size_t>(LEAF_TRIANGLES, node.indices.size() / 6) * 3;
+            float error = 0.0f;
+            node.indices = MeshSimplifier::simplify(node.vertices, node.indices, target, error);
+            node.error = geometricError + error;
+        }
+
+        MeshOptimizer::optimizeVertexCache(node.indices, node.vertices.size());
+        MeshOptimizer::optimizeVertexFetch(node.vertices, node.indices);
+        node.id = writeNode(builder, tree, node, children, childError);
+        return node;
+    }
+
+    // Triângulos da folha com os vértices renumerados a partir de 0
+    static void gatherLeaf(Builder &builder, const SubMesh &submesh, const unsigned int *triangles,
+                           size_t count, NodeGeometry &node)
+    {
+        node.indices.reserve(count * 3);
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int v = submesh.indices[triangles[i] * 3 + k];
+                if (builder.remap[v] == NO_NODE)
+                {
+                    builder.remap[v] = static_cast<unsigned int>(node.vertices.size());
+                    node.vertices.push_back(submesh.vertices[v]);
+                }
+                node.indices.push_back(builder.remap[v]);
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+            for (int k = 0; k < 3; ++k)
+                builder.remap[submesh.indices[triangles[i] * 3 + k]] = NO_NODE;
+
+        Bounds b = Bounds::fromVertices(node.vertices);
+        node.min = b.min;
+        node.max = b.max;
+    }
+
+    static void mergeChildren(const NodeGeometry &left, const NodeGeometry &right, NodeGeometry &node)
+    {
+        std::unordered_map<VertexKey, unsigned int, VertexHash> lookup;
+        lookup.reserve(left.vertices.size() + right.vertices.size());
+        node.indices.reserve(left.indices.size() + right.indices.size());
+        for (const NodeGeometry *child : {&left, &right})
+        {
+            std::vector<unsigned int> remap(child->vertices.size());
+            for (size_t v = 0; v < child->vertices.size(); ++v)
+            {
+                auto inserted = lookup.emplace(VertexKey(child->vertices[v]), (unsigned int)node.vertices.size());
+                if (inserted.second)
+                    node.vertices.push_back(child->vertices[v]);
+                remap[v] = inserted.first->second;
+            }
+            for (unsigned int index : child->indices)
+                node.indices.push_back(remap[index]);
+        }
+    }
+
+    // Quantiza e escreve a geometria do nó; devolve o índice do NodeRecord
+    static uint32_t writeNode(Builder &builder, uint32_t tree, NodeGeometry &node, const uint32_t children[2],
+                              float childError)
+    {
+        QuantizationInfo info = builder.quantization;
+        std::vector<PackedVertex> packed(node.vertices.size());
+        VertexQuantizer::packRange(node.vertices.data(), node.vertices.size(), info, packed.data());
+
+        NodeRecord record = {};
+        Bounds b = Bounds::fromBox(node.min, node.max);
+        std::memcpy(record.boundsMin, &b.min[0], sizeof(record.boundsMin));
+        std::memcpy(record.boundsMax, &b.max[0], sizeof(record.boundsMax));
+        record.radius = b.radius;
+        // a quantização também desloca os vértices; o erro tem de crescer
+        // para cima na árvore para a seleção ser consistente
+        record.error = std::max(node.error + info.maxPositionError, childError);
+        std::memcpy(record.positionOffset, &info.offset[0], sizeof(record.positionOffset));
+        std::memcpy(record.positionScale, &info.scale[0], sizeof(record.positionScale));
+        record.tree = tree;
+        record.parent = NO_NODE;
+        record.children[0] = children[0];
+        record.children[1] = children[1];
+        record.vertexCount = static_cast<uint32_t>(packed.size());
+        record.indexCount = static_cast<uint32_t>(node.indices.size());
+        record.dataOffset = align(builder.offset);
+
+        pad(builder.file, record.dataOffset);
+        builder.file.write(reinterpret_cast<const char *>(packed.data()), packed.size() * sizeof(PackedVertex));
+        builder.file.write(reinterpret_cast<const char *>(node.indices.data()), node.indices.size() * sizeof(unsigned int));
+        builder.offset = record.dataOffset + dataSize(record);
+
+        uint32_t id = static_cast<uint32_t>(builder.nodes.size());
+        for (int c = 0; c < 2; ++c)
+            if (children[c] != NO_NODE)
+                builder.nodes[children[c]].parent = id;
+        builder.nodes.push_back(record);
+        node.recordError = record.error;
+        return id;
+    }
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + 15) & ~uint64_t(15);
+    }
+
+    static void pad(std::ofstream &file, uint64_t offset)
+    {
+        static const char zeros[16] = {};
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        if (offset > position)
+            file.write(zeros, static_cast<std::streamsize>(offset - position));
+    }
+
+    static bool inBounds(uint64_t fileSize, uint64_t offset, uint64_t bytes)
+    {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    }
+};
+
+#endif
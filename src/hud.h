@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include "shader.h"
+
 class HUD
 {
 public:
@@ -51,21 +53,7 @@ public:
             }
         )";
 
-        unsigned int vShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vShader, 1, &panelVertexSource, NULL);
-        glCompileShader(vShader);
-
-        unsigned int fShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fShader, 1, &panelFragmentSource, NULL);
-        glCompileShader(fShader);
-
-        shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vShader);
-        glAttachShader(shaderProgram, fShader);
-        glLinkProgram(shaderProgram);
-
-        glDeleteShader(vShader);
-        glDeleteShader(fShader);
+        shaderProgram = Shader::buildProgram(panelVertexSource, panelFragmentSource);
 
         float quadVertices[] = {
             0.0f, 0.0f,
@@ -348,6 +336,11 @@ public:
             addLine(vertices, x + size * 0.5f, y + size * 0.2f, x + size * 0.5f, y + size * 0.8f);
             addLine(vertices, x + size * 0.2f, y + size * 0.5f, x + size * 0.8f, y + size * 0.5f);
             break;
+        case '%':
+            addLine(vertices, x, y + size, x + size, y);
+            addLine(vertices, x + size * 0.1f, y + size * 0.1f, x + size * 0.3f, y + size * 0.1f);
+            addLine(vertices, x + size * 0.7f, y + size * 0.9f, x + size * 0.9f, y + size * 0.9f);
+            break;
         case ' ':
             break;
         }
@@ -0,0 +1,163 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "gl_ext.h"
+#include "mesh_types.h"
+
+// Desenho comum ao Mesh e ao StreamingMesh: os comandos de
+// glMultiDrawElementsIndirect (primeiro os que têm back-face culling), o
+// índice de cada draw como atributo instanciado lido em baseInstance, o
+// SSBO de DrawData (binding DRAW_DATA_BINDING) e o bloco uniforme de
+// materiais (binding MATERIAL_BINDING). Quem o usa é dono do VAO, VBO e
+// EBO. Só no thread de GL.
+class IndirectDraw
+{
+public:
+    static constexpr GLuint DRAW_DATA_BINDING = 0;
+    static constexpr GLuint MATERIAL_BINDING = 0;
+    static constexpr GLuint DRAW_ID_ATTRIBUTE = 2; // aDrawId no vertex.glsl
+    static constexpr size_t MAX_MATERIALS = 256;   // = tamanho do array em fragment.glsl
+
+    IndirectDraw() = default;
+    IndirectDraw(const IndirectDraw &) = delete;
+    IndirectDraw &operator=(const IndirectDraw &) = delete;
+
+    bool isCreated() const { return indirectBuffer != 0; }
+    const std::vector<DrawElementsIndirectCommand> &commands() const { return drawCommands; }
+
+    static GpuMaterial gpuMaterial(const Material &m)
+    {
+        GpuMaterial g = {};
+        g.ambient = m.ambient;
+        g.diffuse = m.diffuse;
+        g.specular = m.specular;
+        g.shininess = m.shininess;
+        return g;
+    }
+
+    void create()
+    {
+        glGenBuffers(1, &drawIdBuffer);
+        glGenBuffers(1, &indirectBuffer);
+        glGenBuffers(1, &drawDataBuffer);
+        glGenBuffers(1, &materialBuffer);
+    }
+
+    void destroy()
+    {
+        if (!indirectBuffer)
+            return;
+        GLuint buffers[] = {drawIdBuffer, indirectBuffer, drawDataBuffer, materialBuffer};
+        glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers);
+        drawIdBuffer = indirectBuffer = drawDataBuffer = materialBuffer = 0;
+        drawCommands.clear();
+        capacity = 0;
+        backFaceCount = 0;
+    }
+
+    // gl_DrawID só existe em GL 4.6: o índice do draw (0..count-1) chega
+    // como atributo instanciado do VAO, lido na posição baseInstance
+    void setupDrawIds(GLuint vao, size_t count)
+    {
+        std::vector<unsigned int> drawIds(count);
+        for (size_t i = 0; i < count; ++i)
+            drawIds[i] = (unsigned int)i;
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+        glBufferData(GL_ARRAY_BUFFER, drawIds.size() * sizeof(unsigned int), drawIds.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(DRAW_ID_ATTRIBUTE);
+        glVertexAttribIPointer(DRAW_ID_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void *)0);
+        glVertexAttribDivisor(DRAW_ID_ATTRIBUTE, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void uploadDrawData(const std::vector<DrawData> &drawData)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawDataBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, drawData.size() * sizeof(DrawData), drawData.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // O bloco no shader tem sempre MAX_MATERIALS entradas: as que faltam
+    // ficam a zero e as que sobram são ignoradas
+    void uploadMaterials(const std::vector<GpuMaterial> &materials)
+    {
+        std::vector<GpuMaterial> table(MAX_MATERIALS, GpuMaterial{});
+        std::copy_n(materials.begin(), std::min(materials.size(), MAX_MATERIALS), table.begin());
+        glBindBuffer(GL_UNIFORM_BUFFER, materialBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, table.size() * sizeof(GpuMaterial), table.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // Capacidade do buffer indireto, em comandos; ao crescer os comandos
+    // voltam a ser enviados no próximo update
+    void reserve(size_t count)
+    {
+        if (count <= capacity)
+            return;
+        capacity = count;
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        drawCommands.clear();
+    }
+
+    // Comandos do frame, os primeiros backFaceCommands com back-face
+    // culling; só volta a enviar o buffer indireto quando a lista muda
+    void update(const DrawElementsIndirectCommand *commands, size_t count, size_t backFaceCommands)
+    {
+        backFaceCount = backFaceCommands;
+        reserve(count);
+        bool changed = count != drawCommands.size() ||
+                       std::memcmp(commands, drawCommands.data(), count * sizeof(DrawElementsIndirectCommand)) != 0;
+        if (!changed)
+            return;
+        drawCommands.assign(commands, commands + count);
+        if (count == 0)
+            return;
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), drawCommands.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // (No máximo) duas chamadas: primeiro os comandos com back-face
+    // culling, depois os de dupla face. Deixa GL_CULL_FACE desligado.
+    void draw(GLuint vao) const
+    {
+        if (drawCommands.empty())
+            return;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, drawDataBuffer);
+        glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, materialBuffer);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        if (backFaceCount > 0)
+        {
+            glEnable(GL_CULL_FACE);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)backFaceCount, 0);
+            glDisable(GL_CULL_FACE);
+        }
+        if (drawCommands.size() > backFaceCount)
+        {
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                        (void *)(backFaceCount * sizeof(DrawElementsIndirectCommand)),
+                                        (GLsizei)(drawCommands.size() - backFaceCount), 0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+private:
+    unsigned int drawIdBuffer = 0, indirectBuffer = 0, drawDataBuffer = 0, materialBuffer = 0;
+    std::vector<DrawElementsIndirectCommand> drawCommands; // o que está no buffer indireto
+    size_t capacity = 0;
+    size_t backFaceCount = 0;
+};
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <charconv>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Árvore JSON mínima (só leitura) para o cabeçalho dos ficheiros glTF.
+// Campos e índices em falta devolvem um valor nulo em vez de lançar, por
+// isso os acessos encadeados (v["a"][0]["b"]) são sempre seguros.
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    // Devolve false (e out nulo) se o texto não for JSON válido
+    static bool parse(const char *begin, const char *end, JsonValue &out)
+    {
+        Parser parser{begin, end};
+        out = JsonValue();
+        if (!parser.parseValue(out, 0))
+        {
+            out = JsonValue();
+            return false;
+        }
+        parser.skipSpaces();
+        return parser.p == end;
+    }
+
+    Type type() const { return kind; }
+    bool isNull() const { return kind == Type::Null; }
+    bool isNumber() const { return kind == Type::Number; }
+    bool isString() const { return kind == Type::String; }
+    bool isArray() const { return kind == Type::Array; }
+    bool isObject() const { return kind == Type::Object; }
+
+    // Elementos de um array ou pares de um objeto
+    size_t size() const { return kind == Type::Array ? items.size() : kind == Type::Object ? members.size() : 0; }
+
+    const JsonValue &operator[](size_t index) const
+    {
+        return kind == Type::Array && index < items.size() ? items[index] : null();
+    }
+
+    // Evita a ambiguidade de v[0] entre size_t e const char *
+    const JsonValue &operator[](int index) const
+    {
+        return index >= 0 ? (*this)[(size_t)index] : null();
+    }
+
+    const JsonValue &operator[](const char *key) const
+    {
+        if (kind == Type::Object)
+            for (const auto &member : members)
+                if (member.first == key)
+                    return member.second;
+        return null();
+    }
+
+    bool has(const char *key) const { return !(*this)[key].isNull(); }
+
+    double number(double fallback = 0.0) const { return kind == Type::Number ? value : fallback; }
+    bool boolean(bool fallback = false) const { return kind == Type::Bool ? value != 0.0 : fallback; }
+    const std::string &string() const { return text; }
+
+    // Índice de glTF (inteiro >= 0); -1 se em falta, fracionário ou grande
+    // demais (a conversão de um double fora do alcance de long não é definida)
+    long index() const
+    {
+        if (kind != Type::Number || !(value >= 0.0 && value <= 2147483647.0) ||
+            value != static_cast<double>(static_cast<long>(value)))
+            return -1;
+        return static_cast<long>(value);
+    }
+
+private:
+    Type kind = Type::Null;
+    double value = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    static const JsonValue &null()
+    {
+        static const JsonValue empty;
+        return empty;
+    }
+
+    struct Parser
+    {
+        const char *p;
+        const char *end;
+
+        static constexpr int MAX_DEPTH = 256;
+
+        void skipSpaces()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+                ++p;
+        }
+
+        bool literal(const char *word)
+        {
+            for (; *word; ++word, ++p)
+                if (p >= end || *p != *word)
+                    return false;
+            return true;
+        }
+
+        bool parseValue(JsonValue &out, int depth)
+        {
+            skipSpaces();
+            if (p >= end || depth > MAX_DEPTH)
+                return false;
+
+            switch (*p)
+            {
+            case '{':
+                return parseObject(out, depth);
+            case '[':
+                return parseArray(out, depth);
+            case '"':
+                out.kind = Type::String;
+                return parseString(out.text);
+            case 't':
+                out.kind = Type::Bool;
+                out.value = 1.0;
+                return literal("true");
+            case 'f':
+                out.kind = Type::Bool;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+                return parseNumber(out);
+            }
+        }
+
+        bool parseNumber(JsonValue &out)
+        {
+            auto result = std::from_chars(p, end, out.value);
+            if (result.ec != std::errc() || result.ptr == p)
+                return false;
+            out.kind = Type::Number;
+            p = result.ptr;
+            return true;
+        }
+
+        static int hexDigit(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        bool parseHex4(unsigned int &code)
+        {
+            code = 0;
+            for (int i = 0; i < 4; ++i, ++p)
+            {
+                int digit = p < end ? hexDigit(*p) : -1;
+                if (digit < 0)
+                    return false;
+                code = code * 16 + digit;
+            }
+            return true;
+        }
+
+        static void appendUtf8(std::string &s, unsigned int code)
+        {
+            if (code < 0x80)
+                s += static_cast<char>(code);
+            else if (code < 0x800)
+            {
+                s += static_cast<char>(0xC0 | (code >> 6));
+                s += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                s += static_cast<char>(0xE0 | (code >> 12));
+                s += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                s += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                s += static_cast<char>(0xF0 | (code >> 18));
+                s += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                s += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                s += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool parseString(std::string &out)
+        {
+            ++p; // '"'
+            out.clear();
+            while (p < end && *p != '"')
+            {
+                if (*p != '\\')
+                {
+                    out += *p++;
+                    continue;
+                }
+                if (++p >= end)
+                    return false;
+                char c = *p++;
+                switch (c)
+                {
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned int code;
+                    if (!parseHex4(code))
+                        return false;
+                    // par substituto UTF-16
+                    if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                    {
+                        p += 2;
+                        unsigned int low;
+                        if (!parseHex4(low) || low < 0xDC00 || low >= 0xE000)
+                            return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: // '"', '\\', '/'
+                    out += c;
+                    break;
+                }
+            }
+            if (p >= end)
+                return false;
+            ++p; // '"'
+            return true;
+        }
+
+        bool parseArray(JsonValue &out, int depth)
+        {
+            ++p; // '['
+            out.kind = Type::Array;
+            skipSpaces();
+            if (p < end && *p == ']')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                out.items.emplace_back();
+                if (!parseValue(out.items.back(), depth + 1))
+                    return false;
+                skipSpaces();
+                if (p < end && *p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == ']')
+                {
+                    ++p;
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        bool parseObject(JsonValue &out, int depth)
+        {
+            ++p; // '{'
+            out.kind = Type::Object;
+            skipSpaces();
+            if (p < end && *p == '}')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                skipSpaces();
+                if (p >= end || *p != '"')
+                    return false;
+                out.members.emplace_back();
+                if (!parseString(out.members.back().first))
+                    return false;
+                skipSpaces();
+                if (p >= end || *p != ':')
+                    return false;
+                ++p;
+                if (!parseValue(out.members.back().second, depth + 1))
+                    return false;
+                skipSpaces();
+                if (p < end && *p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == '}')
+                {
+                    ++p;
+                    return true;
+                }
+                return false;
+            }
+        }
+    };
+};
+
+#endif
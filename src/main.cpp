@@ -7,10 +7,19 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <cstring>
+#include <chrono>
+#include <random>
 
+#include "gl_ext.h"
 #include "shader.h"
 #include "camera.h"
 #include "mesh.h"
+#include "mesh_registry.h"
+#include "frustum.h"
+#include "staging_ring.h"
+#include "frame_uniforms.h"
+#include "streaming_mesh.h"
 #include "background.h"
 #include "hud.h"
 #include "sun.h"
@@ -28,15 +37,49 @@ float lastFrame = 0.0f;
 
 bool mousePressed = false;
 bool cameraLightEnabled = true;
+bool fogEnabled = false;
+
+// Clique direito: seleção no próximo frame (precisa das matrizes e do Mesh)
+bool pickRequested = false;
+float pickX = 0.0f, pickY = 0.0f;
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+void pickMesh(Mesh &mesh, const glm::mat4 &model, const glm::mat4 &viewProjection);
+void runBvhBenchmark(Mesh &mesh);
+
+void runUniformBenchmark(Shader &shader, FrameUniforms &frameUniforms);
+
+// Funcionalidades dos shaders iluminados (barco e água) para o estado atual;
+// cada combinação é uma variante sem ramos dinâmicos (ver ShaderVariants)
+ShaderDefines sceneDefines()
+{
+    return {{"LIGHT_COUNT", "2"},
+            {"CAMERA_LIGHT", cameraLightEnabled ? "1" : "0"},
+            {"GAMMA", "1"},
+            {"FOG", fogEnabled ? "1" : "0"}};
+}
 
-int main()
+int main(int argc, char **argv)
 {
+    // --build-hlod <obj>: pré-processa o modelo num .boathlod e sai;
+    // --stream <boathlod>: desenha esse modelo em streaming no lugar do barco
+    bool benchmark = false;
+    const char *buildHlodPath = nullptr;
+    const char *streamPath = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--bench") == 0)
+            benchmark = true;
+        else if (std::strcmp(argv[i], "--build-hlod") == 0 && i + 1 < argc)
+            buildHlodPath = argv[++i];
+        else if (std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc)
+            streamPath = argv[++i];
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -61,23 +104,83 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    if (!loadGLExtensions((GLADloadproc)glfwGetProcAddress))
+        return -1;
 
     glEnable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE); // desenhar frente e verso dos triângulos
+    glDisable(GL_CULL_FACE); // frente e verso; Mesh::Draw liga o culling só nos SubMeshes fechados
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_MULTISAMPLE);
     glClearColor(0.02f, 0.05f, 0.15f, 1.0f);
 
-    // Compilar shaders
-    Shader shader("shaders/vertex.glsl", "shaders/fragment.glsl");
-    Shader waterShader("shaders/water_vertex.glsl", "shaders/water_fragment.glsl");
-    Shader backgroundShader("shaders/background_vertex.glsl", "shaders/background_fragment.glsl");
-    Shader sunShader("shaders/sun_vertex.glsl", "shaders/sun_fragment.glsl");
+    // Compilar shaders (ou restaurá-los da ProgramCache): todos são
+    // submetidos já e o driver compila-os em paralelo com o arranque; o
+    // ciclo de render só os usa quando poll() diz que estão prontos
+    auto shadersStart = std::chrono::high_resolution_clock::now();
+    ShaderVariants litShaders("shaders/vertex.glsl", "shaders/fragment.glsl");
+    ShaderVariants waterShaders("shaders/water_vertex.glsl", "shaders/water_fragment.glsl");
+    Shader backgroundShader("shaders/background_vertex.glsl", "shaders/background_fragment.glsl", {},
+                            ShaderBuildMode::Async);
+    Shader sunShader("shaders/sun_vertex.glsl", "shaders/sun_fragment.glsl", {}, ShaderBuildMode::Async);
+
+    // Variantes em uso (nullptr até a primeira estar pronta) e as pedidas
+    // por L/F; a anterior continua a desenhar até a nova estar pronta
+    Shader *shader = nullptr, *waterShader = nullptr;
+    Shader *pendingShader = &litShaders.get(sceneDefines(), ShaderBuildMode::Async);
+    Shader *pendingWaterShader = &waterShaders.get(sceneDefines(), ShaderBuildMode::Async);
+    bool variantCameraLight = cameraLightEnabled, variantFog = fogEnabled;
+    bool shadersLogged = false;
+    std::cout << "Shaders submitted in " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - shadersStart).count()
+              << " ms (" << (glext_KHR_parallel_shader_compile ? "parallel" : "serial") << " compile)" << std::endl;
+
+    // Câmara e luzes vão nos UBOs partilhados; por programa só fica model
+    FrameUniforms frameUniforms;
+    Uniform<glm::mat4> boatModelUniform, waterModelUniform;
+
+    // Uploads de geometria passam por um anel de staging com limite de bytes
+    // por frame (sem ARB_buffer_storage, vão diretamente com glBufferSubData)
+    StagingRing uploadRing;
+    uploadRing.create();
+
+    // Carregar recursos (o barco carrega em segundo plano; até estar pronto
+    // o HUD mostra o progresso no lugar dele). Meshes pedidos ao registo
+    // partilham parsing e buffers quando o conteúdo é o mesmo.
+    MeshRegistry meshes;
+    if (buildHlodPath)
+    {
+        // só o LOD 0 em memória: sem LODs, meshlets, cache nem upload
+        bool built = HlodFile::build(Mesh::loadSource(buildHlodPath), HlodFile::hlodPath(buildHlodPath));
+        if (!built)
+            std::cout << "ERROR: could not build HLOD for " << buildHlodPath << std::endl;
+        uploadRing.destroy();
+        frameUniforms.destroy();
+        glfwTerminate();
+        return built ? 0 : -1;
+    }
 
-    // Carregar recursos
-    Mesh boat("models/Boat.obj");
+    // Casco em streaming (fora do núcleo): só os nós pedidos pela vista
+    // ficam em memória, dentro dos orçamentos de CPU e GPU
+    std::unique_ptr<StreamingMesh> hull;
+    std::shared_ptr<Mesh> boat;
+    if (streamPath)
+        hull = std::make_unique<StreamingMesh>(streamPath);
+    else
+        boat = meshes.acquire("models/Boat.obj", true, MeshLoadMode::Async);
+    if (benchmark && boat)
+    {
+        boat->finishLoading();
+        runBvhBenchmark(*boat);
+        pendingShader->finish();
+        runUniformBenchmark(*pendingShader, frameUniforms);
+        boat.reset();
+        uploadRing.destroy();
+        frameUniforms.destroy();
+        glfwTerminate();
+        return 0;
+    }
     Background background;
     WaterPlane water;
     Sun sun(glm::vec3(30.0f, 25.0f, -20.0f));
@@ -112,55 +215,131 @@ int main()
         }
 
         processInput(window);
+        meshes.update(Mesh::UPLOAD_BUDGET_MS, &uploadRing);
+        if (hull)
+            hull->update(StreamingMesh::UPLOAD_BUDGET_MS, &uploadRing);
+        uploadRing.submit();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom),
                                                 (float)SCR_WIDTH / (float)SCR_HEIGHT,
                                                 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 viewProjection = projection * view;
+        Frustum frustum = Frustum::fromMatrix(viewProjection);
+        size_t drawnObjects = 0, culledObjects = 0;
+
+        FrameData frameData;
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.viewPos = camera.Position;
+        frameData.time = currentFrame;
+        LightData lightData = {};
+        lightData.lightPos1 = lightPos1;
+        lightData.lightPos2 = lightPos2;
+        lightData.lightPos3 = camera.Position;
+        lightData.lightColor = lightColor;
+        frameUniforms.upload(frameData, lightData);
+
+        // L e F pedem outra variante (compilada só da primeira vez)
+        if (cameraLightEnabled != variantCameraLight || fogEnabled != variantFog)
+        {
+            pendingShader = &litShaders.get(sceneDefines(), ShaderBuildMode::Async);
+            pendingWaterShader = &waterShaders.get(sceneDefines(), ShaderBuildMode::Async);
+            variantCameraLight = cameraLightEnabled;
+            variantFog = fogEnabled;
+        }
+        if (pendingShader && pendingShader->poll())
+        {
+            if (shader)
+                std::cout << "Switched to " << pendingShader->label << " (built in " << std::fixed
+                          << std::setprecision(2) << pendingShader->buildTime.count() * 1000.0 << " ms)" << std::endl;
+            shader = pendingShader;
+            boatModelUniform = shader->uniform<glm::mat4>("model");
+            pendingShader = nullptr;
+        }
+        if (pendingWaterShader && pendingWaterShader->poll())
+        {
+            waterShader = pendingWaterShader;
+            waterModelUniform = waterShader->uniform<glm::mat4>("model");
+            pendingWaterShader = nullptr;
+        }
+        bool backgroundReady = backgroundShader.poll();
+        bool sunReady = sunShader.poll();
+        if (!shadersLogged && shader && waterShader && backgroundReady && sunReady)
+        {
+            std::cout << "Shaders ready after " << std::fixed << std::setprecision(2)
+                      << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - shadersStart).count()
+                      << " ms: " << ProgramCache::loadedPrograms << " from the binary cache, "
+                      << ProgramCache::compiledPrograms << " compiled" << std::endl;
+            shadersLogged = true;
+        }
 
         // Desenhar Background
-        backgroundShader.use();
-        background.Draw();
+        if (backgroundReady)
+        {
+            backgroundShader.use();
+            background.Draw();
+        }
 
-        // Desenhar o Sol
-        glDisable(GL_DEPTH_TEST); // Sol sempre visível
-        sunShader.use();
-        sun.Draw(sunShader.ID, view, projection);
-        glEnable(GL_DEPTH_TEST);
+        // Desenhar o Sol (como a água e o barco, fica de fora enquanto o
+        // programa compila)
+        if (sunReady && frustum.intersects(sun.getBounds()))
+        {
+            glDisable(GL_DEPTH_TEST); // Sol sempre visível
+            sun.Draw(sunShader);
+            glEnable(GL_DEPTH_TEST);
+            drawnObjects++;
+        }
+        else if (sunReady)
+        {
+            culledObjects++;
+        }
 
         // Desenhar a Água
-        glEnable(GL_BLEND);
-        waterShader.use();
-        waterShader.setMat4("projection", projection);
-        waterShader.setMat4("view", view);
-        waterShader.setFloat("time", currentFrame);
-        waterShader.setVec3("lightPos1", lightPos1);
-        waterShader.setVec3("lightPos2", lightPos2);
-        waterShader.setVec3("lightPos3", camera.Position);
-        waterShader.setBool("cameraLightEnabled", cameraLightEnabled);
-        waterShader.setVec3("viewPos", camera.Position);
-        waterShader.setVec3("lightColor", lightColor);
-
-        glm::mat4 waterModel = glm::mat4(1.0f);
-        waterShader.setMat4("model", waterModel);
-        water.Draw();
-        glDisable(GL_BLEND);
+        if (waterShader && frustum.intersects(water.bounds))
+        {
+            glEnable(GL_BLEND);
+            waterShader->use();
+            glm::mat4 waterModel = glm::mat4(1.0f);
+            waterModelUniform.set(waterModel);
+            water.Draw();
+            glDisable(GL_BLEND);
+            drawnObjects++;
+        }
+        else if (waterShader)
+        {
+            culledObjects++;
+        }
 
         // Desenhar o Barco
-        shader.use();
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
-        shader.setVec3("lightPos1", lightPos1);
-        shader.setVec3("lightPos2", lightPos2);
-        shader.setVec3("lightPos3", camera.Position);
-        shader.setBool("cameraLightEnabled", cameraLightEnabled);
-        shader.setVec3("viewPos", camera.Position);
-        shader.setVec3("lightColor", lightColor);
-
         glm::mat4 boatModel = glm::mat4(1.0f);
-        shader.setMat4("model", boatModel);
-        boat.Draw(shader);
+        if (shader)
+        {
+            shader->use();
+            boatModelUniform.set(boatModel);
+        }
+        if (boat && shader)
+        {
+            boat->cullFrustum(viewProjection, boatModel, camera.Position);
+            boat->selectLod(boatModel, camera.Position, glm::radians(camera.Zoom), (float)SCR_HEIGHT);
+            boat->Draw();
+            drawnObjects += boat->drawnSubmeshes;
+            culledObjects += boat->culledSubmeshes;
+        }
+        if (hull && shader)
+        {
+            hull->selectNodes(viewProjection, boatModel, camera.Position, glm::radians(camera.Zoom), (float)SCR_HEIGHT);
+            hull->Draw();
+            drawnObjects += hull->drawnNodes;
+        }
+
+        if (pickRequested)
+        {
+            pickRequested = false;
+            if (boat)
+                pickMesh(*boat, boatModel, viewProjection);
+        }
 
         // Desenhar o HUD
         glDisable(GL_DEPTH_TEST);
@@ -226,9 +405,9 @@ int main()
         hud.DrawText(zoomText.str(), 20, 125, 8, glm::vec4(0.7f, 0.7f, 0.9f, 1.0f));
 
         // Painel de Controlos (Inferior Esquerdo)
-        float ctrlY = SCR_HEIGHT - 210;
+        float ctrlY = SCR_HEIGHT - 232;
         float ctrlW = 340;
-        float ctrlH = 200;
+        float ctrlH = 222;
 
         // Painel com bordas
         hud.DrawPanel(10, ctrlY, ctrlW, ctrlH, glm::vec4(0.0f, 0.0f, 0.0f, 0.75f));
@@ -273,14 +452,24 @@ int main()
         hud.DrawText("> TOGGLE LUZ", 105, lineY, 8, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
         lineY += lineSpacing;
 
+        hud.DrawText("F", 22, lineY + 2, 8, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
+        hud.DrawText("F", 20, lineY, 8, glm::vec4(1.0f, 0.9f, 0.3f, 1.0f));
+        hud.DrawText("> TOGGLE NEVOEIRO", 105, lineY, 8, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
+        lineY += lineSpacing;
+
+        hud.DrawText("BTN DIR", 22, lineY + 2, 8, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
+        hud.DrawText("BTN DIR", 20, lineY, 8, glm::vec4(1.0f, 0.9f, 0.3f, 1.0f));
+        hud.DrawText("> SELECIONAR", 105, lineY, 8, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
+        lineY += lineSpacing;
+
         hud.DrawText("ESC", 22, lineY + 2, 8, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
         hud.DrawText("ESC", 20, lineY, 8, glm::vec4(1.0f, 0.5f, 0.5f, 1.0f));
         hud.DrawText("> SAIR", 105, lineY, 8, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
 
         // Mini Info (Canto Superior Direito)
         float infoX = SCR_WIDTH - 200;
-        hud.DrawPanel(infoX - 5, 10, 195, 65, glm::vec4(0.0f, 0.0f, 0.0f, 0.7f));
-        hud.DrawPanel(infoX - 3, 12, 191, 61, glm::vec4(0.1f, 0.15f, 0.2f, 0.8f));
+        hud.DrawPanel(infoX - 5, 10, 195, 82, glm::vec4(0.0f, 0.0f, 0.0f, 0.7f));
+        hud.DrawPanel(infoX - 3, 12, 191, 78, glm::vec4(0.1f, 0.15f, 0.2f, 0.8f));
 
         hud.DrawText("PHONG SHADING", infoX + 2, 22, 7, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
         hud.DrawText("PHONG SHADING", infoX, 20, 7, glm::vec4(0.8f, 0.6f, 1.0f, 1.0f));
@@ -291,6 +480,29 @@ int main()
         hud.DrawText("OPENGL 4.3", infoX + 2, 56, 7, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
         hud.DrawText("OPENGL 4.3", infoX, 54, 7, glm::vec4(0.6f, 0.9f, 1.0f, 1.0f));
 
+        // Objetos desenhados / rejeitados pelo frustum culling
+        std::stringstream cullText;
+        cullText << "DRAWN: " << drawnObjects << " CULLED: " << culledObjects;
+        hud.DrawText(cullText.str(), infoX + 2, 73, 7, glm::vec4(0.0f, 0.0f, 0.0f, 0.4f));
+        hud.DrawText(cullText.str(), infoX, 71, 7, glm::vec4(0.6f, 1.0f, 0.7f, 1.0f));
+
+        // Placeholder até haver um nível do barco para desenhar
+        if (boat && !boat->isDrawable())
+        {
+            float loadW = 300, loadH = 56;
+            float loadX = (SCR_WIDTH - loadW) / 2, loadY = (SCR_HEIGHT - loadH) / 2;
+            hud.DrawPanel(loadX, loadY, loadW, loadH, glm::vec4(0.0f, 0.0f, 0.0f, 0.75f));
+            hud.DrawPanel(loadX + 2, loadY + 2, loadW - 4, loadH - 4, glm::vec4(0.05f, 0.1f, 0.15f, 0.85f));
+
+            std::stringstream loadText;
+            loadText << "A CARREGAR BARCO " << std::fixed << std::setprecision(0) << boat->loadProgress() * 100.0f << "%";
+            hud.DrawText(loadText.str(), loadX + 12, loadY + 12, 8, glm::vec4(1.0f, 0.8f, 0.3f, 1.0f));
+
+            float barW = loadW - 24;
+            hud.DrawPanel(loadX + 12, loadY + 34, barW, 10, glm::vec4(0.15f, 0.25f, 0.35f, 0.9f));
+            hud.DrawPanel(loadX + 12, loadY + 34, barW * boat->loadProgress(), 10, glm::vec4(0.5f, 0.8f, 1.0f, 1.0f));
+        }
+
         glLineWidth(1.0f);
         glDisable(GL_BLEND);
         glEnable(GL_DEPTH_TEST);
@@ -304,6 +516,10 @@ int main()
     }
 
     std::cout << "\nEncerrando..." << std::endl;
+    boat.reset(); // buffers libertados ainda com o contexto ativo
+    hull.reset();
+    uploadRing.destroy(); // fences e mapeamento persistente, idem
+    frameUniforms.destroy();
     glfwTerminate();
     return 0;
 }
@@ -335,6 +551,16 @@ void processInput(GLFWwindow *window)
             lastToggle = glfwGetTime();
         }
     }
+
+    static float lastFogToggle = 0.0f;
+    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
+    {
+        if (glfwGetTime() - lastFogToggle > 0.3f)
+        {
+            fogEnabled = !fogEnabled;
+            lastFogToggle = glfwGetTime();
+        }
+    }
 }
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
@@ -379,6 +605,172 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
             mousePressed = false;
         }
     }
+    else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+    {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        pickX = static_cast<float>(x);
+        pickY = static_cast<float>(y);
+        pickRequested = true;
+    }
+}
+
+// Raio do near plane ao far plane pelo pixel (pickX, pickY)
+void pickMesh(Mesh &mesh, const glm::mat4 &model, const glm::mat4 &viewProjection)
+{
+    float ndcX = 2.0f * pickX / SCR_WIDTH - 1.0f;
+    float ndcY = 1.0f - 2.0f * pickY / SCR_HEIGHT;
+    glm::mat4 inverseVP = glm::inverse(viewProjection);
+    glm::vec4 nearPoint = inverseVP * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseVP * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+
+    Ray ray;
+    ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+    ray.direction = glm::vec3(farPoint) / farPoint.w - ray.origin;
+    ray.tMax = 1.0f;
+
+    RayHit hit;
+    if (mesh.raycast(ray, model, hit))
+    {
+        std::cout << "Picked submesh " << hit.submesh << " (material " << mesh.materialName(hit.submesh)
+                  << "), triangle " << hit.triangle << " at (" << std::fixed << std::setprecision(3)
+                  << hit.point.x << ", " << hit.point.y << ", " << hit.point.z << ")" << std::endl;
+    }
+    else
+    {
+        std::cout << "Picked nothing" << std::endl;
+    }
+}
+
+// --bench: tempo de construção da BVH e débito de raios sobre o Mesh
+void runBvhBenchmark(Mesh &mesh)
+{
+    using clock = std::chrono::high_resolution_clock;
+    const int BUILD_RUNS = 10;
+    const size_t RAY_COUNT = 1 << 18;
+
+    double buildMs = std::numeric_limits<double>::max();
+    MeshBVH bvh;
+    for (int i = 0; i < BUILD_RUNS; ++i)
+    {
+        auto start = clock::now();
+        bvh = MeshBVH();
+        bvh.build(mesh.submeshes);
+        buildMs = std::min(buildMs, std::chrono::duration<double, std::milli>(clock::now() - start).count());
+    }
+
+    // Origens numa esfera à volta do Mesh, a apontar para pontos da AABB
+    std::mt19937 rng(47933);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Ray> rays(RAY_COUNT);
+    for (Ray &ray : rays)
+    {
+        float z = unit(rng) * 2.0f - 1.0f, phi = unit(rng) * 6.2831853f;
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        ray.origin = mesh.bounds.center + glm::vec3(r * std::cos(phi), r * std::sin(phi), z) * mesh.bounds.radius * 2.0f;
+        glm::vec3 target = mesh.bounds.min + (mesh.bounds.max - mesh.bounds.min) * glm::vec3(unit(rng), unit(rng), unit(rng));
+        ray.direction = target - ray.origin;
+    }
+
+    std::vector<RayHit> hits(RAY_COUNT);
+    auto start = clock::now();
+    size_t closestHits = 0;
+    for (size_t i = 0; i < RAY_COUNT; ++i)
+        closestHits += bvh.closestHit(rays[i], hits[i]) ? 1 : 0;
+    double closestSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    start = clock::now();
+    size_t anyHits = 0;
+    for (const Ray &ray : rays)
+        anyHits += bvh.anyHit(ray) ? 1 : 0;
+    double anySeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    start = clock::now();
+    bvh.closestHits(rays.data(), rays.size(), hits.data());
+    double batchSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "BVH: " << bvh.triangleCount() << " triangles, " << bvh.nodeCount() << " nodes, build "
+              << buildMs << " ms (best of " << BUILD_RUNS << ")\n"
+              << "  closest hit: " << RAY_COUNT / closestSeconds / 1e6 << " Mrays/s ("
+              << 100.0 * closestHits / RAY_COUNT << "% hit)\n"
+              << "  any hit:     " << RAY_COUNT / anySeconds / 1e6 << " Mrays/s ("
+              << 100.0 * anyHits / RAY_COUNT << "% hit)\n"
+              << "  batched:     " << RAY_COUNT / batchSeconds / 1e6 << " Mrays/s ("
+              << std::thread::hardware_concurrency() << " threads)" << std::endl;
+}
+
+// --bench: CPU gasto por frame a dar ao barco a câmara e as luzes: nove
+// uniforms pelo nome (glGetUniformLocation, como antes da reflexão) contra
+// o upload dos UBOs FrameData/LightData e o handle de model. Os shaders do
+// barco já não declaram esses uniforms, por isso o caso "pelo nome" usa um
+// programa de referência que ainda os tem todos ativos.
+void runUniformBenchmark(Shader &shader, FrameUniforms &frameUniforms)
+{
+    const char *referenceVertexSource = R"(
+        #version 430 core
+        layout (location = 0) in vec3 aPos;
+        uniform mat4 projection;
+        uniform mat4 view;
+        uniform mat4 model;
+        void main()
+        {
+            gl_Position = projection * view * model * vec4(aPos, 1.0);
+        }
+    )";
+    const char *referenceFragmentSource = R"(
+        #version 430 core
+        uniform vec3 lightPos1;
+        uniform vec3 lightPos2;
+        uniform vec3 lightPos3;
+        uniform vec3 viewPos;
+        uniform vec3 lightColor;
+        uniform bool cameraLightEnabled;
+        out vec4 FragColor;
+        void main()
+        {
+            vec3 c = (lightPos1 + lightPos2 + (cameraLightEnabled ? lightPos3 : vec3(0.0)) - viewPos) * lightColor;
+            FragColor = vec4(c, 1.0);
+        }
+    )";
+    unsigned int reference = Shader::buildProgram(referenceVertexSource, referenceFragmentSource);
+
+    using clock = std::chrono::high_resolution_clock;
+    const int FRAMES = 20000;
+    const char *matrices[] = {"projection", "view", "model"};
+    const char *vectors[] = {"lightPos1", "lightPos2", "lightPos3", "viewPos", "lightColor"};
+    glm::mat4 matrix(1.0f);
+    glm::vec3 vector(1.0f);
+    glUseProgram(reference);
+
+    auto start = clock::now();
+    for (int i = 0; i < FRAMES; ++i)
+    {
+        for (const char *name : matrices)
+            glUniformMatrix4fv(glGetUniformLocation(reference, std::string(name).c_str()), 1, GL_FALSE, &matrix[0][0]);
+        for (const char *name : vectors)
+            glUniform3fv(glGetUniformLocation(reference, std::string(name).c_str()), 1, &vector[0]);
+        glUniform1i(glGetUniformLocation(reference, std::string("cameraLightEnabled").c_str()), 1);
+    }
+    double byNameUs = std::chrono::duration<double, std::micro>(clock::now() - start).count() / FRAMES;
+    glDeleteProgram(reference);
+
+    shader.use();
+    Uniform<glm::mat4> model = shader.uniform<glm::mat4>("model");
+    FrameData frameData = {matrix, matrix, vector, 0.0f};
+    LightData lightData = {};
+    start = clock::now();
+    for (int i = 0; i < FRAMES; ++i)
+    {
+        frameUniforms.upload(frameData, lightData);
+        model.set(matrix);
+    }
+    double blockUs = std::chrono::duration<double, std::micro>(clock::now() - start).count() / FRAMES;
+
+    std::cout << std::fixed << std::setprecision(3) << "Uniforms (" << shader.activeUniforms().size()
+              << " active in the boat program): " << byNameUs
+              << " us/frame by name (reference program without UBOs), " << blockUs
+              << " us/frame with the frame/light UBOs" << std::endl;
 }
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
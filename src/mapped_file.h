@@ -0,0 +1,143 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Ficheiro mapeado em memória só de leitura (mmap / MapViewOfFile).
+// Ficheiros vazios não são mapeados e open() devolve false.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const char *filepath)
+    {
+        open(filepath);
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+    {
+        *this = static_cast<MappedFile &&>(other);
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            fileData = other.fileData;
+            fileSize = other.fileSize;
+#ifdef _WIN32
+            fileHandle = other.fileHandle;
+            mappingHandle = other.mappingHandle;
+            other.fileHandle = INVALID_HANDLE_VALUE;
+            other.mappingHandle = NULL;
+#endif
+            other.fileData = nullptr;
+            other.fileSize = 0;
+        }
+        return *this;
+    }
+
+    bool open(const char *filepath)
+    {
+        close();
+#ifdef _WIN32
+        fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        fileSize = static_cast<size_t>(size.QuadPart);
+
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mappingHandle != NULL)
+            fileData = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(filepath, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st = {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            fileSize = static_cast<size_t>(st.st_size);
+            void *ptr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED)
+            {
+                fileData = static_cast<const char *>(ptr);
+                madvise(ptr, fileSize, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+#endif
+        if (!fileData)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (fileData)
+            UnmapViewOfFile(fileData);
+        if (mappingHandle != NULL)
+            CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(fileHandle);
+        mappingHandle = NULL;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (fileData)
+            munmap(const_cast<char *>(fileData), fileSize);
+#endif
+        fileData = nullptr;
+        fileSize = 0;
+    }
+
+    const char *data() const { return fileData; }
+    size_t size() const { return fileSize; }
+    bool isOpen() const { return fileData != nullptr; }
+
+private:
+    const char *fileData = nullptr;
+    size_t fileSize = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = NULL;
+#endif
+};
+
+#endif
@@ -9,28 +9,39 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <atomic>
+#include <thread>
 
-struct Vertex
-{
-    glm::vec3 Position;
-    glm::vec3 Normal;
-};
-
-struct Material
-{
-    std::string name;
-    glm::vec3 ambient;  // Ka
-    glm::vec3 diffuse;  // Kd
-    glm::vec3 specular; // Ks
-    float shininess;    // Ns
-};
+#include "gl_ext.h"
+#include "frustum.h"
+#include "gltf_loader.h"
+#include "indirect_draw.h"
+#include "mesh_bvh.h"
+#include "mesh_types.h"
+#include "obj_loader.h"
+#include "mapped_file.h"
+#include "staging_ring.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplify.h"
+#include "mesh_topology.h"
+#include "meshlet.h"
+#include "normal_generator.h"
+#include "vertex_quantizer.h"
 
-struct SubMesh
+enum class MeshLoadMode
 {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    Material material;
-    unsigned int VAO, VBO, EBO;
+    Blocking, // tudo no construtor
+    Async     // CPU numa thread de trabalho, upload para a GPU em update()
 };
 
 class Mesh
@@ -38,35 +49,481 @@ class Mesh
 public:
     std::vector<SubMesh> submeshes;
 
-    Mesh(const char *filepath)
+    // Volume envolvente de todo o Mesh no espaço do modelo
+    Bounds bounds;
+
+    // Resultado do último cullFrustum (SubMeshes e meshlets)
+    size_t drawnSubmeshes = 0;
+    size_t culledSubmeshes = 0;
+    size_t drawnMeshlets = 0;
+    size_t culledMeshlets = 0;
+
+    // Tempo máximo de upload por frame no modo assíncrono
+    static constexpr double UPLOAD_BUDGET_MS = 2.0;
+
+    // quantizeVertices: VBO com PackedVertex (12 bytes) em vez de Vertex (24).
+    // Em MeshLoadMode::Async o construtor retorna logo e update() (chamado a
+    // cada frame) envia os LODs do mais simples para o mais detalhado: o
+    // Mesh é desenhado a partir do momento em que o nível mais simples de
+    // todos os SubMeshes está na GPU (isDrawable) e vai sendo refinado até
+    // isReady().
+    Mesh(const char *filepath, bool quantizeVertices = false, MeshLoadMode mode = MeshLoadMode::Blocking)
+        : quantize(quantizeVertices), sourcePath(filepath), loadStart(std::chrono::steady_clock::now())
     {
-        std::string objPath(filepath);
-        std::string mtlPath = objPath.substr(0, objPath.find_last_of('.')) + ".mtl";
+        if (mode == MeshLoadMode::Async)
+        {
+            loader = std::thread([this]()
+                                 {
+                prepare();
+                prepared.store(true, std::memory_order_release); });
+            return;
+        }
 
-        loadMTL(mtlPath.c_str());
-        loadOBJ(filepath);
-        setupMeshes();
+        prepare();
+        prepared.store(true, std::memory_order_relaxed);
+        finishLoading();
+    }
+
+    // Só a geometria de LOD 0 de um OBJ (materiais do .mtl, winding
+    // reparado) ou de um .glb, sem cache, otimização, LODs, meshlets nem GL:
+    // a fonte dos pré-processamentos que fazem o resto à sua maneira
+    // (HlodFile::build). Pode correr sem contexto de GL.
+    static std::vector<SubMesh> loadSource(const std::string &path)
+    {
+        Mesh mesh(path);
+        if (isGlb(path))
+        {
+            MappedFile file(path.c_str());
+            GltfData gltf;
+            std::string error;
+            if (!GltfLoader::parse(file, gltf, error))
+                std::cout << "ERROR: could not load " << path << ": " << error << std::endl;
+            for (GltfPrimitive &primitive : gltf.primitives)
+                if (!primitive.indices.empty())
+                    mesh.submeshes.push_back(mesh.submeshFromPrimitive(primitive));
+        }
+        else
+        {
+            mesh.loadMTL((path.substr(0, path.find_last_of('.')) + ".mtl").c_str());
+            mesh.readOBJ(path.c_str());
+        }
+        return std::move(mesh.submeshes);
+    }
+
+    // Dono dos buffers de GL: não se copia (partilhar com MeshRegistry)
+    Mesh(const Mesh &) = delete;
+    Mesh &operator=(const Mesh &) = delete;
+
+    // Thread de GL, com o contexto ainda ativo. A meio de um upload pelo
+    // anel, as cópias ainda não emitidas para estes buffers são descartadas
+    // (o anel tem de viver mais do que o Mesh).
+    ~Mesh()
+    {
+        if (loader.joinable())
+            loader.join();
+        if (!VAO)
+            return;
+
+        if (uploadRing && !ready)
+        {
+            uploadRing->discard(VBO);
+            uploadRing->discard(EBO);
+        }
+        glDeleteVertexArrays(1, &VAO);
+        GLuint buffers[] = {VBO, EBO};
+        glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers);
+        draws.destroy();
+        std::cout << "Released mesh " << sourcePath << std::endl;
+    }
+
+    bool isReady() const { return ready; }
+
+    // Pelo menos o LOD mais simples de cada SubMesh já pode ser desenhado
+    bool isDrawable() const { return drawable; }
+
+    // 0 enquanto a thread de trabalho processa o modelo, depois a fração já
+    // enviada para a GPU
+    float loadProgress() const
+    {
+        if (ready)
+            return 1.0f;
+        if (preparedChunks.load(std::memory_order_acquire) == 0 || uploadTotalBytes == 0)
+            return 0.0f;
+        return (float)uploadedBytes / (float)uploadTotalBytes;
+    }
+
+    // Thread de GL, uma vez por frame: continua o upload durante no máximo
+    // budgetMs (pelo menos um bloco por chamada), com os blocos que a thread
+    // de trabalho já publicou. Com um StagingRing os blocos são escritos no
+    // anel e copiados pela GPU no ring->submit() do frame, dentro do limite
+    // de bytes do anel; um nível só passa a ser desenhado no frame seguinte
+    // ao da sua última cópia. Devolve isReady().
+    bool update(double budgetMs = UPLOAD_BUDGET_MS, StagingRing *ring = nullptr)
+    {
+        if (ready)
+            return true;
+        // prepared primeiro: depois dele todos os blocos estão publicados
+        bool cpuFinished = prepared.load(std::memory_order_acquire);
+        size_t available = preparedChunks.load(std::memory_order_acquire);
+        if (available == 0 && !cpuFinished)
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        if (uploadSteps == 0)
+            beginUpload();
+        if (cpuFinished && !cpuDone)
+        {
+            if (loader.joinable())
+                loader.join();
+            cpuDone = true; // meshlets prontos
+            if (drawable)
+                draws.reserve(maxDrawCommands);
+        }
+
+        bool staged = ring && ring->isAvailable();
+        while (uploadChunk < available)
+        {
+            if (!uploadSlice(staged ? ring : nullptr))
+                break; // anel cheio: continua no próximo frame
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budgetMs)
+                break;
+        }
+
+        // Passagens de refinamento enviadas e, se foram pelo anel, já emitidas
+        while (passTickets.size() < passEnd.size() && uploadChunk >= passEnd[passTickets.size()])
+            passTickets.push_back(stagedUpload ? lastStagingTicket + 1 : 0);
+        while (loadedPasses < passTickets.size() &&
+               (passTickets[loadedPasses] == 0 || uploadRing->isSubmitted(passTickets[loadedPasses] - 1)))
+            loadedPasses++;
+
+        uploadSteps++;
+        uploadTime += std::chrono::steady_clock::now() - start;
+        if (!drawable && (loadedPasses > 0 || passEnd.empty()))
+        {
+            finishSetup();
+            drawable = true;
+            if (!cpuDone || loadedPasses < passEnd.size())
+                logFirstDraw();
+        }
+        if (!cpuDone || loadedPasses < passEnd.size())
+            return false;
+
+        finishUpload();
+        ready = true;
+        std::cout << "Uploaded mesh " << sourcePath << ": " << std::fixed << std::setprecision(2)
+                  << uploadTotalBytes / (1024.0 * 1024.0) << " MB in " << uploadSteps
+                  << (uploadSteps == 1 ? " step (" : " steps (") << uploadTime.count() * 1000.0 << " ms, "
+                  << passEnd.size() << (passEnd.size() == 1 ? " level)" : " levels)")
+                  << std::defaultfloat << std::endl;
+        passEnd.clear();
+        passTickets.clear();
+        return true;
+    }
+
+    // Espera pela thread de trabalho e envia o que falta de uma vez (sem
+    // anel; não usar a meio de um upload feito com StagingRing)
+    void finishLoading()
+    {
+        if (loader.joinable())
+            loader.join();
+        update(std::numeric_limits<double>::infinity());
     }
 
-    void Draw(class Shader &shader)
+    // Escolhe, por SubMesh, o LOD mais simples cujo erro projetado no ecrã
+    // não passa de maxPixelError pixels; enquanto o carregamento progressivo
+    // decorre, Draw troca-o pelo mais detalhado que já está na GPU
+    void selectLod(const glm::mat4 &model, const glm::vec3 &viewPos, float fovY,
+                   float viewportHeight, float maxPixelError = 1.0f)
     {
+        if (!drawable)
+            return;
+
+        glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float distance = glm::length(viewPos - center) - bounds.radius * scale;
+        float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f) * std::max(distance, 1e-3f));
+
         for (auto &submesh : submeshes)
         {
-            // Aplicar material
-            shader.setVec3("material.ambient", submesh.material.ambient);
-            shader.setVec3("material.diffuse", submesh.material.diffuse);
-            shader.setVec3("material.specular", submesh.material.specular);
-            shader.setFloat("material.shininess", submesh.material.shininess);
+            submesh.currentLod = 0;
+            for (size_t l = 1; l < submesh.lods.size(); ++l)
+            {
+                if (submesh.lods[l].error * scale * pixelsPerUnit > maxPixelError)
+                    break;
+                submesh.currentLod = static_cast<unsigned int>(l);
+            }
+        }
+    }
 
-            glBindVertexArray(submesh.VAO);
-            glDrawElements(GL_TRIANGLES, submesh.indices.size(), GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
+    // Marca os SubMeshes fora do frustum; os planos são passados para o
+    // espaço do modelo, por isso os volumes são testados sem transformação.
+    // As esferas são testadas em lote (SSE) e as que passam são refinadas
+    // pela AABB. Depois, os meshlets (só usados no LOD 0) são testados pela
+    // esfera e, nos SubMeshes com back-face culling, pelo cone de normais
+    // contra viewPos (posição da câmara no mundo).
+    void cullFrustum(const glm::mat4 &viewProjection, const glm::mat4 &model, const glm::vec3 &viewPos)
+    {
+        if (!drawable)
+            return;
+
+        Frustum frustum = Frustum::fromMatrix(viewProjection * model);
+        sphereVisible.resize(submeshes.size());
+        frustum.testSpheres(sphereX.data(), sphereY.data(), sphereZ.data(), sphereRadius.data(),
+                            submeshes.size(), sphereVisible.data());
+
+        drawnSubmeshes = 0;
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            SubMesh &submesh = submeshes[i];
+            submesh.visible = sphereVisible[i] && frustum.intersectsBox(submesh.bounds.min, submesh.bounds.max);
+            drawnSubmeshes += submesh.visible ? 1 : 0;
         }
+        culledSubmeshes = submeshes.size() - drawnSubmeshes;
+        if (!cpuDone)
+            return; // meshlets ainda em construção na thread de trabalho
+
+        glm::vec3 cameraPos = glm::vec3(glm::inverse(model) * glm::vec4(viewPos, 1.0f));
+        drawnMeshlets = meshletCuller.cull(frustum, cameraPos);
+        culledMeshlets = meshletCuller.size() - drawnMeshlets;
+        meshletsCulled = true;
+    }
+
+    // Todos os SubMeshes em (no máximo) duas chamadas: primeiro os fechados,
+    // com back-face culling, depois os de dupla face (ver IndirectDraw).
+    // Deixa GL_CULL_FACE desligado.
+    void Draw()
+    {
+        if (!drawable || submeshes.empty())
+            return;
+
+        updateDrawCommands();
+        draws.draw(VAO);
+    }
+
+    // BVH sobre os triângulos de LOD 0, construída no primeiro uso
+    const MeshBVH &getBvh()
+    {
+        if (ready && bvh.empty() && !submeshes.empty())
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            bvh.build(submeshes);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << "Built BVH in " << std::fixed << std::setprecision(2) << ms << " ms: "
+                      << bvh.nodeCount() << " nodes, " << bvh.triangleCount() << " triangles" << std::endl;
+        }
+        return bvh;
+    }
+
+    // Raio no espaço do mundo; o hit (t e ponto) volta no espaço do mundo
+    bool raycast(const Ray &worldRay, const glm::mat4 &model, RayHit &hit)
+    {
+        glm::mat4 inverseModel = glm::inverse(model);
+        Ray ray;
+        ray.origin = glm::vec3(inverseModel * glm::vec4(worldRay.origin, 1.0f));
+        ray.direction = glm::vec3(inverseModel * glm::vec4(worldRay.direction, 0.0f));
+        ray.tMax = worldRay.tMax; // transformação afim: t mantém-se
+        if (!getBvh().closestHit(ray, hit))
+            return false;
+        hit.point = glm::vec3(model * glm::vec4(hit.point, 1.0f));
+        return true;
+    }
+
+    const std::string &materialName(unsigned int submesh) const
+    {
+        return submeshes[submesh].material.name;
     }
 
 private:
+    // Mesh vazio, sem GL, para loadSource
+    explicit Mesh(const std::string &path) : quantize(false), sourcePath(path) {}
+
     std::map<std::string, Material> materials;
     Material defaultMaterial;
+    bool quantize;
+    QuantizationInfo quantizationError; // pior caso entre todos os SubMeshes
+    MeshBVH bvh;
+
+    // Carregamento: a thread de trabalho corre prepare(), publica os blocos
+    // de upload à medida que ficam prontos (preparedChunks) e no fim marca
+    // prepared; o resto (drawable, ready, estado do upload) só é usado no
+    // thread de GL
+    std::string sourcePath;
+    std::chrono::steady_clock::time_point loadStart;
+    std::thread loader;
+    std::atomic<size_t> preparedChunks{0};
+    std::atomic<bool> prepared{false};
+    bool cpuDone = false;        // prepared já visto por update(): meshlets prontos
+    bool meshletsCulled = false; // cullFrustum já testou os meshlets
+    bool drawable = false;
+    bool ready = false;
+
+    // Bloco contíguo a copiar para o VBO ou o EBO
+    struct UploadChunk
+    {
+        bool indexBuffer;
+        size_t offset; // bytes no buffer de destino
+        size_t size;
+        const void *data;       // nulo até publishChunks() quantizar unpacked
+        const Vertex *unpacked; // vértices a quantizar, ou nulo
+        unsigned int submesh;
+    };
+    static constexpr size_t UPLOAD_SLICE_BYTES = 256 * 1024; // por glBufferSubData
+
+    // Dados preparados no CPU que só vivem até ao fim do upload
+    MappedFile sourceFile; // fontes do upload quando o Mesh vem da cache ou de um .glb
+    std::vector<std::vector<PackedVertex>> packedVertices;
+    std::vector<GpuMaterial> gpuMaterials;
+    std::vector<DrawData> drawData;
+    std::vector<UploadChunk> uploadChunks;
+    std::vector<size_t> passEnd;       // fim (em blocos) de cada passagem de refinamento
+    std::vector<uint64_t> passTickets; // passagens enviadas: 0 sem anel, senão último ticket + 1
+    size_t loadedPasses = 0;           // passagens que já podem ser desenhadas
+    size_t uploadChunk = 0, uploadChunkOffset = 0;
+    size_t vertexBufferSize = 0, indexBufferSize = 0;
+    size_t uploadedBytes = 0, uploadTotalBytes = 0;
+    unsigned int uploadSteps = 0;
+    StagingRing *uploadRing = nullptr; // anel usado no upload, se algum
+    bool stagedUpload = false;         // algum bloco foi pelo StagingRing
+    uint64_t lastStagingTicket = 0;
+    std::chrono::duration<double> uploadTime{0.0};
+
+    // Um VBO/EBO para todos os SubMeshes; os comandos indiretos, DrawData
+    // (um por SubMesh) e materiais ficam em draws
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    IndirectDraw draws;
+    std::vector<unsigned int> drawOrder; // SubMeshes com culling primeiro
+    std::vector<DrawElementsIndirectCommand> commandScratch;
+
+    // Esferas dos SubMeshes em SoA para Frustum::testSpheres
+    std::vector<float> sphereX, sphereY, sphereZ, sphereRadius;
+    std::vector<unsigned char> sphereVisible;
+
+    // Meshlets de todos os SubMeshes (por ordem) e o primeiro de cada um
+    MeshletCuller meshletCuller;
+    std::vector<size_t> firstMeshlet;
+    size_t maxDrawCommands = 0; // comandos no pior caso (um por meshlet)
+
+    // Todo o trabalho de CPU (sem chamadas GL): cache ou OBJ, processamento
+    // e preparação dos dados do upload; um .glb é lido tal como está
+    void prepare()
+    {
+        if (isGlb(sourcePath))
+        {
+            loadGLB(sourcePath);
+            publishChunks();
+            logQuantization();
+            return;
+        }
+
+        std::string mtlPath = sourcePath.substr(0, sourcePath.find_last_of('.')) + ".mtl";
+        std::string cachePath = MeshCache::cachePath(sourcePath);
+
+        // Cache binária válida: sem parsing de texto (e sem ler o OBJ se os
+        // ficheiros de origem não mudaram desde que foi escrita)
+        MeshCache::SourceStamp stamp = MeshCache::SourceStamp::of(sourcePath, mtlPath);
+        uint64_t sourceHash = MeshCache::storedHash(cachePath, stamp);
+        if (sourceHash == 0)
+            sourceHash = MeshCache::hashSources(sourcePath, mtlPath);
+        if (sourceHash != 0 && loadCache(cachePath, sourceHash))
+        {
+            logQuantization();
+            return;
+        }
+
+        loadMTL(mtlPath.c_str());
+        loadOBJ(sourcePath.c_str());
+        prepareUploadFromSubmeshes();
+        publishChunks();
+        logQuantization();
+
+        if (sourceHash != 0 && !submeshes.empty())
+        {
+            if (MeshCache::write(cachePath, sourceHash, stamp, bounds.radius, submeshes))
+                std::cout << "Wrote mesh cache " << cachePath << std::endl;
+            else
+                std::cout << "WARNING: could not write mesh cache " << cachePath << std::endl;
+        }
+    }
+
+    static bool isGlb(const std::string &path)
+    {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos)
+            return false;
+        std::string extension = path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return (char)std::tolower(c); });
+        return extension == "glb";
+    }
+
+    // Primitivas de triângulos do .glb, uma por SubMesh. O asset já vem
+    // processado do pipeline de exportação: sem reparação de winding,
+    // otimização nem LODs (o back-face culling segue doubleSided). Os
+    // buffers com o layout do VBO/EBO são enviados diretamente do ficheiro
+    // mapeado, que fica aberto até ao fim do upload.
+    void loadGLB(const std::string &path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        MappedFile file(path.c_str());
+        GltfData gltf;
+        std::string error;
+        if (!GltfLoader::parse(file, gltf, error))
+        {
+            std::cout << "ERROR: could not load " << path << ": " << error << std::endl;
+            return;
+        }
+
+        std::vector<UploadSource> sources;
+        size_t zeroCopyBytes = 0, totalBytes = 0, triangles = 0;
+        for (GltfPrimitive &primitive : gltf.primitives)
+        {
+            if (primitive.indices.empty())
+                continue;
+
+            SubMesh submesh = submeshFromPrimitive(primitive);
+
+            size_t vertexBytes = submesh.vertices.size() * sizeof(Vertex);
+            size_t indexBytes = submesh.indices.size() * sizeof(unsigned int);
+            // com quantização os vértices são sempre reempacotados
+            zeroCopyBytes += (primitive.mappedVertices && !quantize ? vertexBytes : 0) +
+                             (primitive.mappedIndices ? indexBytes : 0);
+            totalBytes += vertexBytes + indexBytes;
+            triangles += submesh.indices.size() / 3;
+            submeshes.push_back(std::move(submesh));
+
+            const SubMesh &added = submeshes.back();
+            sources.push_back({primitive.mappedVertices ? primitive.mappedVertices : added.vertices.data(),
+                               primitive.mappedIndices ? primitive.mappedIndices : added.indices.data(),
+                               added.lodIndices.data()});
+        }
+        if (gltf.skippedPrimitives > 0)
+            std::cout << "WARNING: skipped " << gltf.skippedPrimitives << " unsupported primitives in " << path << std::endl;
+
+        computeBounds();
+        buildMeshlets();
+        prepareUpload(sources);
+        sourceFile = std::move(file);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Loaded GLB " << path << ": " << submeshes.size() << " submeshes, " << triangles
+                  << " triangles in " << std::fixed << std::setprecision(2) << elapsed.count() * 1000.0
+                  << " ms (" << zeroCopyBytes / 1024 << "/" << totalBytes / 1024 << " KB uploaded from the mapped file)"
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Move a geometria da primitiva para um SubMesh com um único LOD
+    SubMesh submeshFromPrimitive(GltfPrimitive &primitive) const
+    {
+        SubMesh submesh{};
+        submesh.material = primitive.hasMaterial ? primitive.material : defaultMaterial;
+        submesh.cullBackFaces = !primitive.doubleSided;
+        submesh.vertices = std::move(primitive.vertices);
+        submesh.indices = std::move(primitive.indices);
+        submesh.lods.assign(1, {0, (unsigned int)submesh.indices.size(), 0.0f, (unsigned int)submesh.vertices.size()});
+        return submesh;
+    }
 
     void loadMTL(const char *filepath)
     {
@@ -135,220 +592,707 @@ private:
 
     void loadOBJ(const char *filepath)
     {
-        std::ifstream file(filepath);
-        if (!file.is_open())
+        if (!readOBJ(filepath))
+            return;
+
+        optimizeSubmeshes();
+        generateLods();
+        orderVerticesByLod();
+        computeBounds();
+        buildMeshlets();
+
+        size_t vertexCount = 0, indexCount = 0;
+        for (auto &submesh : submeshes)
+        {
+            vertexCount += submesh.vertices.size();
+            indexCount += submesh.indices.size();
+        }
+        std::cout << "Loaded OBJ: " << submeshes.size() << " submeshes, " << indexCount / 3
+                  << " triangles, " << vertexCount << " unique vertices (" << indexCount
+                  << " before welding)" << std::endl;
+    }
+
+    // Parsing, normais em falta, soldadura e winding: os SubMeshes com o
+    // LOD 0 tal como vem do ficheiro (sem lods)
+    bool readOBJ(const char *filepath)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        MappedFile file(filepath);
+        if (!file.isOpen())
         {
             std::cout << "ERROR::MESH::FILE_NOT_FOUND: " << filepath << std::endl;
-            return;
+            return false;
         }
 
-        std::vector<glm::vec3> temp_positions;
-        std::vector<glm::vec3> temp_normals;
+        ObjData obj;
+        unsigned int threads = ObjParser::parseParallel(file.data(), file.data() + file.size(), obj);
 
-        SubMesh currentSubmesh;
-        currentSubmesh.material = defaultMaterial;
-        std::string currentMaterialName = "";
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double megabytes = file.size() / (1024.0 * 1024.0);
+        std::cout << "Parsed OBJ " << filepath << ": " << std::fixed << std::setprecision(2)
+                  << megabytes << " MB in " << elapsed.count() * 1000.0 << " ms ("
+                  << megabytes / std::max(elapsed.count(), 1e-9) << " MB/s, "
+                  << threads << (threads == 1 ? " thread)" : " threads)")
+                  << std::defaultfloat << std::endl;
 
-        std::vector<unsigned int> position_indices;
-        std::vector<unsigned int> normal_indices;
+        // Sem "vn": normais suaves por posição, calculadas sobre as faces de
+        // todos os grupos (cada canto usa então a normal da sua posição)
+        if (obj.normals.empty() && !obj.groups.empty())
+        {
+            auto normalStart = std::chrono::steady_clock::now();
+            std::vector<const std::vector<unsigned int> *> faces;
+            for (auto &group : obj.groups)
+                faces.push_back(&group.position_indices);
+            unsigned int normalThreads = NormalGenerator::computeSmooth(obj.positions, faces, obj.normals);
 
-        std::string line;
-        while (std::getline(file, line))
+            std::chrono::duration<double> normalElapsed = std::chrono::steady_clock::now() - normalStart;
+            std::cout << "Calculated smooth normals for " << obj.positions.size() << " positions in "
+                      << std::fixed << std::setprecision(2) << normalElapsed.count() * 1000.0 << " ms ("
+                      << normalThreads << (normalThreads == 1 ? " thread)" : " threads)")
+                      << std::defaultfloat << std::endl;
+        }
+
+        for (auto &group : obj.groups)
         {
-            if (line.empty())
-                continue;
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
+            SubMesh submesh{};
+            auto it = group.hasMaterial ? materials.find(group.material) : materials.end();
+            submesh.material = (it != materials.end()) ? it->second : defaultMaterial;
 
-            if (prefix == "v")
-            {
-                glm::vec3 pos;
-                iss >> pos.x >> pos.y >> pos.z;
-                temp_positions.push_back(pos);
-            }
-            else if (prefix == "vn")
+            buildSubmesh(submesh, obj.positions, obj.normals,
+                         group.position_indices, group.normal_indices);
+            submeshes.push_back(std::move(submesh));
+        }
+
+        repairWinding();
+        return true;
+    }
+
+    // Orientação consistente dos triângulos; os SubMeshes fechados passam a
+    // ser desenhados com back-face culling
+    void repairWinding()
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t flipped = 0, components = 0, closedComponents = 0, closedSubmeshes = 0;
+
+        for (auto &submesh : submeshes)
+        {
+            WindingReport report = MeshTopology::repairWinding(submesh.vertices, submesh.indices);
+            submesh.cullBackFaces = report.closed;
+            flipped += report.flippedTriangles;
+            components += report.components;
+            closedComponents += report.closedComponents;
+            closedSubmeshes += report.closed ? 1 : 0;
+            if (report.conflicts > 0)
+                std::cout << "WARNING: submesh " << submesh.material.name << " is not orientable ("
+                          << report.conflicts << " conflicting edges)" << std::endl;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Repaired winding in " << std::fixed << std::setprecision(2) << elapsed.count() * 1000.0
+                  << " ms: " << flipped << " triangles flipped, " << closedComponents << "/" << components
+                  << " components closed, back-face culling on " << closedSubmeshes << "/" << submeshes.size()
+                  << " submeshes" << std::defaultfloat << std::endl;
+    }
+
+    // Ordem dos triângulos para a cache de vértices, depois para overdraw,
+    // e por fim ordem dos vértices para a leitura do VBO
+    void optimizeSubmeshes()
+    {
+        auto start = std::chrono::steady_clock::now();
+        double before[2] = {0.0, 0.0}, after[2] = {0.0, 0.0};
+        size_t triangles = 0, vertices = 0;
+
+        for (auto &submesh : submeshes)
+        {
+            MeshOptimizer::CacheStats stats = MeshOptimizer::analyzeVertexCache(submesh.indices, submesh.vertices.size());
+            size_t t = submesh.indices.size() / 3;
+            before[0] += stats.acmr * t;
+            before[1] += stats.atvr * submesh.vertices.size();
+
+            MeshOptimizer::optimizeVertexCache(submesh.indices, submesh.vertices.size());
+            MeshOptimizer::optimizeOverdraw(submesh.indices, submesh.vertices);
+            MeshOptimizer::optimizeVertexFetch(submesh.vertices, submesh.indices);
+
+            stats = MeshOptimizer::analyzeVertexCache(submesh.indices, submesh.vertices.size());
+            after[0] += stats.acmr * t;
+            after[1] += stats.atvr * submesh.vertices.size();
+            triangles += t;
+            vertices += submesh.vertices.size();
+        }
+
+        if (triangles == 0)
+            return;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Optimized submeshes in " << std::fixed << std::setprecision(2) << elapsed.count() * 1000.0
+                  << " ms: ACMR " << before[0] / triangles << " -> " << after[0] / triangles
+                  << ", ATVR " << before[1] / vertices << " -> " << after[1] / vertices
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Cadeia de LODs: cada nível é simplificado a partir do anterior, por isso
+    // o erro acumula-se. Pára quando a simplificação deixa de reduzir.
+    void generateLods()
+    {
+        static const float targets[] = {0.5f, 0.25f, 0.1f, 0.03f};
+        auto start = std::chrono::steady_clock::now();
+        size_t levels = 0;
+
+        for (auto &submesh : submeshes)
+        {
+            submesh.lodIndices.clear();
+            submesh.lods.assign(1, {0, (unsigned int)submesh.indices.size(), 0.0f, (unsigned int)submesh.vertices.size()});
+
+            std::vector<unsigned int> previous = submesh.indices;
+            float error = 0.0f;
+            for (float target : targets)
             {
-                glm::vec3 n;
-                iss >> n.x >> n.y >> n.z;
-                temp_normals.push_back(glm::normalize(n));
+                size_t targetCount = (size_t)(submesh.indices.size() * target) / 3 * 3;
+                if (targetCount < 3)
+                    break;
+
+                float levelError = 0.0f;
+                std::vector<unsigned int> lod = MeshSimplifier::simplify(submesh.vertices, previous,
+                                                                         targetCount, levelError);
+                if (lod.empty() || lod.size() > previous.size() * 9 / 10)
+                    break;
+
+                MeshOptimizer::optimizeVertexCache(lod, submesh.vertices.size());
+                error += levelError;
+
+                MeshLod level;
+                level.indexOffset = (unsigned int)(submesh.indices.size() + submesh.lodIndices.size());
+                level.indexCount = (unsigned int)lod.size();
+                level.error = error;
+                level.vertexCount = (unsigned int)submesh.vertices.size(); // até orderVerticesByLod
+                submesh.lods.push_back(level);
+                submesh.lodIndices.insert(submesh.lodIndices.end(), lod.begin(), lod.end());
+                previous.swap(lod);
+                ++levels;
             }
-            else if (prefix == "usemtl")
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Generated " << levels << " LOD levels in " << std::fixed << std::setprecision(2)
+                  << elapsed.count() * 1000.0 << " ms" << std::defaultfloat << std::endl;
+    }
+
+    // Vértices por ordem de primeiro uso do LOD mais simples para o mais
+    // detalhado: cada nível passa a usar só um prefixo do VBO do SubMesh
+    // (MeshLod::vertexCount), que pode ser desenhado antes de o resto dos
+    // vértices chegar. Dentro de cada nível fica a ordem de primeiro uso,
+    // como em optimizeVertexFetch.
+    void orderVerticesByLod()
+    {
+        const unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+        for (auto &submesh : submeshes)
+        {
+            std::vector<unsigned int> remap(submesh.vertices.size(), UNUSED);
+            unsigned int next = 0;
+            for (size_t l = submesh.lods.size(); l-- > 0;)
             {
-                // fecha o submesh anterior
-                if (!position_indices.empty())
-                {
-                    buildSubmesh(currentSubmesh, temp_positions, temp_normals,
-                                 position_indices, normal_indices);
-                    submeshes.push_back(currentSubmesh);
-                    currentSubmesh = SubMesh{};
-                    currentSubmesh.material = defaultMaterial;
-                    position_indices.clear();
-                    normal_indices.clear();
-                }
-                iss >> currentMaterialName;
-                auto it = materials.find(currentMaterialName);
-                currentSubmesh.material = (it != materials.end()) ? it->second : defaultMaterial;
+                MeshLod &lod = submesh.lods[l];
+                const unsigned int *levelIndices = l == 0 ? submesh.indices.data()
+                                                          : submesh.lodIndices.data() + (lod.indexOffset - submesh.indices.size());
+                for (unsigned int i = 0; i < lod.indexCount; ++i)
+                    if (remap[levelIndices[i]] == UNUSED)
+                        remap[levelIndices[i]] = next++;
+                lod.vertexCount = next;
             }
-            else if (prefix == "f")
-            {
-                // Lê todos os vértices dad face
-                std::vector<std::string> vtokens;
-                std::string tok;
-                while (iss >> tok)
-                    vtokens.push_back(tok);
-                if (vtokens.size() < 3)
-                    continue;
+            // vértices que nenhum triângulo usa ficam no fim
+            for (unsigned int &r : remap)
+                if (r == UNUSED)
+                    r = next++;
+            submesh.lods[0].vertexCount = next;
 
-                // converter cada token "v/vt/vn" -> índices
-                struct Idx
-                {
-                    unsigned int p, n;
-                };
-                std::vector<Idx> verts;
-                verts.reserve(vtokens.size());
-                for (auto &vs : vtokens)
-                {
-                    unsigned int p = 0, n = 0;
-                    parseVertex(vs, p, n);
-                    verts.push_back({p, n});
-                }
+            std::vector<Vertex> ordered(submesh.vertices.size());
+            for (size_t v = 0; v < remap.size(); ++v)
+                ordered[remap[v]] = submesh.vertices[v];
+            submesh.vertices.swap(ordered);
+            for (unsigned int &index : submesh.indices)
+                index = remap[index];
+            for (unsigned int &index : submesh.lodIndices)
+                index = remap[index];
+        }
+    }
 
-                // Triangulação em Leque: (v0, v[i], v[i+1])
-                for (size_t i = 1; i + 1 < verts.size(); ++i)
-                {
-                    position_indices.push_back(verts[0].p);
-                    position_indices.push_back(verts[i].p);
-                    position_indices.push_back(verts[i + 1].p);
+    void computeBounds()
+    {
+        for (auto &submesh : submeshes)
+            submesh.bounds = Bounds::fromVertices(submesh.vertices);
+        combineBounds();
 
-                    normal_indices.push_back(verts[0].n);
-                    normal_indices.push_back(verts[i].n);
-                    normal_indices.push_back(verts[i + 1].n);
-                }
-            }
+        bounds.radius = 0.0f;
+        for (auto &submesh : submeshes)
+            for (auto &v : submesh.vertices)
+                bounds.radius = std::max(bounds.radius, glm::length(v.Position - bounds.center));
+    }
+
+    // AABB do Mesh (raio da AABB) e esferas dos SubMeshes em SoA, a partir
+    // dos volumes já calculados de cada SubMesh
+    void combineBounds()
+    {
+        sphereX.clear();
+        sphereY.clear();
+        sphereZ.clear();
+        sphereRadius.clear();
+
+        glm::vec3 minP(std::numeric_limits<float>::max()), maxP(-std::numeric_limits<float>::max());
+        for (auto &submesh : submeshes)
+        {
+            minP = glm::min(minP, submesh.bounds.min);
+            maxP = glm::max(maxP, submesh.bounds.max);
+
+            sphereX.push_back(submesh.bounds.center.x);
+            sphereY.push_back(submesh.bounds.center.y);
+            sphereZ.push_back(submesh.bounds.center.z);
+            sphereRadius.push_back(submesh.bounds.radius);
         }
+        bounds = minP.x > maxP.x ? Bounds() : Bounds::fromBox(minP, maxP);
+    }
 
-        // guarda último submesh
-        if (!position_indices.empty())
+    // Meshlets do LOD 0 de cada SubMesh, refeitos a cada carregamento (a
+    // partição só depende da ordem do EBO, que a cache guarda)
+    void buildMeshlets()
+    {
+        auto start = std::chrono::steady_clock::now();
+        meshletCuller.clear();
+        firstMeshlet.clear();
+        maxDrawCommands = 0;
+        for (auto &submesh : submeshes)
         {
-            buildSubmesh(currentSubmesh, temp_positions, temp_normals,
-                         position_indices, normal_indices);
-            submeshes.push_back(currentSubmesh);
+            submesh.meshlets = MeshletBuilder::build(submesh.vertices, submesh.indices);
+            firstMeshlet.push_back(meshletCuller.size());
+            for (const Meshlet &m : submesh.meshlets)
+                meshletCuller.add(m, submesh.cullBackFaces);
+            maxDrawCommands += std::max<size_t>(1, submesh.meshlets.size());
         }
 
-        file.close();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Built " << meshletCuller.size() << " meshlets in " << std::fixed << std::setprecision(2)
+                  << elapsed.count() * 1000.0 << " ms" << std::defaultfloat << std::endl;
     }
 
     void buildSubmesh(SubMesh &submesh,
                       const std::vector<glm::vec3> &temp_positions,
-                      std::vector<glm::vec3> &temp_normals,
+                      const std::vector<glm::vec3> &temp_normals,
                       const std::vector<unsigned int> &position_indices,
                       const std::vector<unsigned int> &normal_indices)
     {
+        // Soldar vértices: cada par (posição, normal) dá origem a um único
+        // vértice, para que o índice reutilize os cantos partilhados
+        std::unordered_map<uint64_t, unsigned int> vertexLookup;
+        vertexLookup.reserve(position_indices.size());
+        submesh.vertices.reserve(position_indices.size() / 4);
+        submesh.indices.reserve(position_indices.size());
 
-        if (temp_normals.empty())
+        for (size_t i = 0; i < position_indices.size(); i++)
         {
-            std::cout << "Calculating smooth normals..." << std::endl;
-            temp_normals.resize(temp_positions.size(), glm::vec3(0.0f));
-            std::vector<int> normalCount(temp_positions.size(), 0);
+            unsigned int p = position_indices[i];
+            unsigned int n = normal_indices[i];
+            uint64_t key = (uint64_t(p) << 32) | n;
 
-            for (size_t i = 0; i < position_indices.size(); i += 3)
+            auto inserted = vertexLookup.emplace(key, (unsigned int)submesh.vertices.size());
+            if (inserted.second)
             {
-                unsigned int idx0 = position_indices[i] - 1;
-                unsigned int idx1 = position_indices[i + 1] - 1;
-                unsigned int idx2 = position_indices[i + 2] - 1;
+                Vertex vertex;
+                vertex.Position = temp_positions[p - 1];
+                unsigned int normalIdx = n > 0 ? n - 1 : p - 1;
+                vertex.Normal = normalIdx < temp_normals.size() ? temp_normals[normalIdx] : glm::vec3(0.0f, 1.0f, 0.0f);
+                submesh.vertices.push_back(vertex);
+            }
+            submesh.indices.push_back(inserted.first->second);
+        }
+        submesh.vertices.shrink_to_fit();
+    }
+
+    bool loadCache(const std::string &cachePath, uint64_t sourceHash)
+    {
+        auto start = std::chrono::steady_clock::now();
 
-                glm::vec3 v0 = temp_positions[idx0];
-                glm::vec3 v1 = temp_positions[idx1];
-                glm::vec3 v2 = temp_positions[idx2];
+        MappedFile file(cachePath.c_str());
+        std::vector<MeshCache::CachedSubmesh> cached;
+        float radius = 0.0f;
+        if (!MeshCache::read(file, sourceHash, cached, radius))
+        {
+            if (file.isOpen())
+                std::cout << "Mesh cache " << cachePath << " is stale, rebuilding..." << std::endl;
+            return false;
+        }
 
-                glm::vec3 edge1 = v1 - v0;
-                glm::vec3 edge2 = v2 - v0;
-                glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+        // Só os registos: o upload começa diretamente a partir do ficheiro
+        // mapeado, com o nível mais simples de cada SubMesh primeiro
+        std::vector<UploadSource> sources;
+        for (auto &c : cached)
+        {
+            SubMesh submesh{};
+            submesh.material = c.material;
+            submesh.lods = c.lods;
+            submesh.bounds = c.bounds;
+            submesh.cullBackFaces = c.cullBackFaces;
+            submeshes.push_back(std::move(submesh));
+            sources.push_back({c.vertices, c.indices, c.indices + c.lods[0].indexCount});
+        }
+        combineBounds();
+        bounds.radius = radius;
+        prepareUpload(sources);
+        sourceFile = std::move(file);
+        publishChunks();
 
-                // Adicionar a normal com o peso baseado na área do triângulo
-                float area = glm::length(glm::cross(edge1, edge2)) * 0.5f;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Loaded mesh cache " << cachePath << ": " << submeshes.size() << " submeshes in "
+                  << std::fixed << std::setprecision(2) << elapsed.count() * 1000.0 << " ms"
+                  << std::defaultfloat << std::endl;
 
-                temp_normals[idx0] += normal * area;
-                temp_normals[idx1] += normal * area;
-                temp_normals[idx2] += normal * area;
+        // Cópias no CPU (BVH, meshlets) enquanto o thread de GL já desenha
+        for (size_t i = 0; i < cached.size(); ++i)
+        {
+            const MeshCache::CachedSubmesh &c = cached[i];
+            SubMesh &submesh = submeshes[i];
+            submesh.vertices.assign(c.vertices, c.vertices + c.vertexCount);
+            submesh.indices.assign(c.indices, c.indices + c.lods[0].indexCount);
+            submesh.lodIndices.assign(c.indices + c.lods[0].indexCount, c.indices + c.indexCount);
+        }
+        buildMeshlets();
+        return true;
+    }
+
+    void logQuantization()
+    {
+        if (!quantize || submeshes.empty())
+            return;
+
+        std::cout << "Quantized vertices: " << sizeof(Vertex) << " -> " << sizeof(PackedVertex)
+                  << " bytes, max position error " << quantizationError.maxPositionError
+                  << ", max normal error " << quantizationError.maxNormalError << " deg" << std::endl;
+    }
+
+    // De onde vêm os dados de cada SubMesh no upload (vetores do SubMesh ou
+    // ficheiro de cache mapeado)
+    struct UploadSource
+    {
+        const Vertex *vertices;
+        const unsigned int *indices;
+        const unsigned int *lodIndices;
+    };
 
-                normalCount[idx0]++;
-                normalCount[idx1]++;
-                normalCount[idx2]++;
+    void prepareUploadFromSubmeshes()
+    {
+        std::vector<UploadSource> sources;
+        for (auto &submesh : submeshes)
+            sources.push_back({submesh.vertices.data(), submesh.indices.data(), submesh.lodIndices.data()});
+        prepareUpload(sources);
+    }
+
+    // Posições dos SubMeshes nos buffers, tabela de materiais, DrawData e
+    // lista de blocos a enviar (CPU). Só usa os registos dos SubMeshes
+    // (lods, volumes): os vértices e índices vêm das fontes. Os blocos vão
+    // por passagens: a k-ésima traz, de cada SubMesh, o k-ésimo LOD a contar
+    // do mais simples (os vértices que ainda não tinham chegado e os índices
+    // desse nível), por isso a primeira já chega para desenhar tudo.
+    void prepareUpload(const std::vector<UploadSource> &sources)
+    {
+        size_t vertexStride = quantize ? sizeof(PackedVertex) : sizeof(Vertex);
+        size_t vertexCount = 0, indexCount = 0, passes = 0;
+        for (auto &submesh : submeshes)
+        {
+            const MeshLod &last = submesh.lods.back();
+            submesh.baseVertex = (unsigned int)vertexCount;
+            submesh.firstIndex = (unsigned int)indexCount;
+            vertexCount += submesh.lods[0].vertexCount;
+            indexCount += last.indexOffset + last.indexCount;
+            passes = std::max(passes, submesh.lods.size());
+        }
+        vertexBufferSize = vertexCount * vertexStride;
+        indexBufferSize = indexCount * sizeof(unsigned int);
+
+        gpuMaterials = buildMaterialTable();
+        drawData.assign(submeshes.size(), DrawData{});
+        packedVertices.assign(quantize ? submeshes.size() : 0, std::vector<PackedVertex>());
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            SubMesh &submesh = submeshes[i];
+            if (quantize)
+            {
+                // escala fixa pela AABB, para quantizar o SubMesh aos bocados;
+                // reservado de uma vez para os blocos publicados não mudarem de sítio
+                QuantizationInfo info = VertexQuantizer::paramsFor(submesh.bounds.min, submesh.bounds.max);
+                submesh.quantized = true;
+                submesh.positionOffset = info.offset;
+                submesh.positionScale = info.scale;
+                packedVertices[i].reserve(submesh.lods[0].vertexCount);
             }
 
-            // Normalizar com suavização
-            for (size_t i = 0; i < temp_normals.size(); i++)
+            DrawData &d = drawData[i];
+            d.materialIndex = submesh.materialIndex;
+            d.positionOffset = glm::vec4(submesh.positionOffset, submesh.quantized ? 1.0f : 0.0f);
+            d.positionScale = glm::vec4(submesh.positionScale, 0.0f);
+        }
+
+        uploadChunks.clear();
+        passEnd.clear();
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t i = 0; i < submeshes.size(); ++i)
             {
-                if (normalCount[i] > 0 && glm::length(temp_normals[i]) > 0.001f)
-                {
-                    temp_normals[i] = glm::normalize(temp_normals[i]);
-                }
-                else
-                {
-                    temp_normals[i] = glm::vec3(0.0f, 1.0f, 0.0f); // fallback
-                }
+                const SubMesh &submesh = submeshes[i];
+                const UploadSource &source = sources[i];
+                if (pass >= submesh.lods.size())
+                    continue;
+
+                size_t l = submesh.lods.size() - 1 - pass;
+                const MeshLod &lod = submesh.lods[l];
+                size_t firstVertex = l + 1 < submesh.lods.size() ? submesh.lods[l + 1].vertexCount : 0;
+                const Vertex *vertices = source.vertices + firstVertex;
+                uploadChunks.push_back({false, (submesh.baseVertex + firstVertex) * vertexStride,
+                                        (lod.vertexCount - firstVertex) * vertexStride,
+                                        quantize ? nullptr : vertices, quantize ? vertices : nullptr,
+                                        (unsigned int)i});
+
+                // EBO = LOD 0 seguido dos restantes LODs, por SubMesh
+                const unsigned int *indices = l == 0 ? source.indices
+                                                     : source.lodIndices + (lod.indexOffset - submesh.lods[0].indexCount);
+                uploadChunks.push_back({true, (submesh.firstIndex + lod.indexOffset) * sizeof(unsigned int),
+                                        lod.indexCount * sizeof(unsigned int), indices, nullptr, (unsigned int)i});
             }
+            passEnd.push_back(uploadChunks.size());
         }
 
-        for (size_t i = 0; i < position_indices.size(); i++)
+        uploadTotalBytes = 0;
+        for (const UploadChunk &chunk : uploadChunks)
+            uploadTotalBytes += chunk.size;
+
+        drawOrder.clear();
+        for (int pass = 0; pass < 2; ++pass)
+            for (size_t i = 0; i < submeshes.size(); ++i)
+                if (submeshes[i].cullBackFaces == (pass == 0))
+                    drawOrder.push_back((unsigned int)i);
+    }
+
+    // Thread de trabalho: quantiza os blocos de vértices (se preciso) e
+    // publica-os para update() pela ordem da lista, por isso o nível mais
+    // simples pode subir enquanto os outros ainda estão a ser empacotados
+    void publishChunks()
+    {
+        for (size_t c = 0; c < uploadChunks.size(); ++c)
         {
-            Vertex vertex;
-            vertex.Position = temp_positions[position_indices[i] - 1];
-            vertex.Normal = normal_indices[i] > 0 ? temp_normals[normal_indices[i] - 1] : temp_normals[position_indices[i] - 1];
-            submesh.vertices.push_back(vertex);
-            submesh.indices.push_back(i);
+            UploadChunk &chunk = uploadChunks[c];
+            if (chunk.unpacked)
+            {
+                const SubMesh &submesh = submeshes[chunk.submesh];
+                std::vector<PackedVertex> &packed = packedVertices[chunk.submesh];
+                size_t first = packed.size(), count = chunk.size / sizeof(PackedVertex);
+                packed.resize(first + count);
+
+                QuantizationInfo info = quantizationError;
+                info.offset = submesh.positionOffset;
+                info.scale = submesh.positionScale;
+                VertexQuantizer::packRange(chunk.unpacked, count, info, packed.data() + first);
+                quantizationError.maxPositionError = info.maxPositionError;
+                quantizationError.maxNormalError = info.maxNormalError;
+                chunk.data = packed.data() + first;
+            }
+            preparedChunks.store(c + 1, std::memory_order_release);
         }
     }
 
-    void parseVertex(const std::string &vertexStr, unsigned int &posIdx, unsigned int &normIdx)
+    // Cria os buffers com o tamanho final; os dados chegam em uploadSlice()
+    void beginUpload()
     {
-        std::istringstream iss(vertexStr);
-        std::string index;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        draws.create();
 
-        std::getline(iss, index, '/');
-        posIdx = std::stoi(index);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, nullptr, GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
-        std::getline(iss, index, '/');
+    // Até UPLOAD_SLICE_BYTES do bloco atual: pelo anel de staging, ou
+    // diretamente pelo alvo genérico GL_COPY_WRITE_BUFFER para não mexer no
+    // estado do VAO. Devolve false se o anel não tem espaço.
+    bool uploadSlice(StagingRing *ring)
+    {
+        const UploadChunk &chunk = uploadChunks[uploadChunk];
+        size_t size = std::min(UPLOAD_SLICE_BYTES, chunk.size - uploadChunkOffset);
+        GLuint buffer = chunk.indexBuffer ? EBO : VBO;
+        const char *data = static_cast<const char *>(chunk.data) + uploadChunkOffset;
+        if (size > 0 && ring)
+        {
+            if (!ring->write(buffer, chunk.offset + uploadChunkOffset, data, size, lastStagingTicket))
+                return false;
+            stagedUpload = true;
+            uploadRing = ring;
+        }
+        else if (size > 0)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, chunk.offset + uploadChunkOffset, size, data);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
 
-        if (std::getline(iss, index, '/'))
+        uploadChunkOffset += size;
+        uploadedBytes += size;
+        if (uploadChunkOffset >= chunk.size)
         {
-            normIdx = index.empty() ? 0 : std::stoi(index);
+            uploadChunk++;
+            uploadChunkOffset = 0;
+        }
+        return true;
+    }
+
+    // Atributos do VAO e buffers pequenos (draw ids, DrawData, materiais,
+    // comandos), quando o primeiro nível chega à GPU
+    void finishSetup()
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        if (quantize)
+        {
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                                  (void *)offsetof(PackedVertex, position));
+            glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+                                  (void *)offsetof(PackedVertex, normal));
         }
         else
         {
-            normIdx = 0;
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                  (void *)offsetof(Vertex, Normal));
         }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        draws.setupDrawIds(VAO, submeshes.size());
+        draws.uploadDrawData(drawData);
+        draws.uploadMaterials(gpuMaterials);
+        // sem meshlets (ainda) basta um comando por SubMesh
+        draws.reserve(cpuDone ? maxDrawCommands : submeshes.size());
     }
 
-    void setupMeshes()
+    void logFirstDraw()
     {
-        for (auto &submesh : submeshes)
+        size_t coarse = 0, full = 0;
+        for (const SubMesh &submesh : submeshes)
         {
-            glGenVertexArrays(1, &submesh.VAO);
-            glGenBuffers(1, &submesh.VBO);
-            glGenBuffers(1, &submesh.EBO);
+            coarse += submesh.lods.back().indexCount / 3;
+            full += submesh.lods[0].indexCount / 3;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - loadStart;
+        std::cout << "First draw of mesh " << sourcePath << " after " << std::fixed << std::setprecision(2)
+                  << elapsed.count() * 1000.0 << " ms: " << coarse << "/" << full << " triangles, "
+                  << uploadedBytes / 1024 << "/" << uploadTotalBytes / 1024 << " KB uploaded"
+                  << std::defaultfloat << std::endl;
+    }
 
-            glBindVertexArray(submesh.VAO);
+    // Liberta os dados que só serviam para o upload
+    void finishUpload()
+    {
+        uploadChunks.clear();
+        uploadChunks.shrink_to_fit();
+        packedVertices.clear();
+        packedVertices.shrink_to_fit();
+        gpuMaterials.clear();
+        gpuMaterials.shrink_to_fit();
+        drawData.clear();
+        drawData.shrink_to_fit();
+        sourceFile = MappedFile();
+    }
 
-            glBindBuffer(GL_ARRAY_BUFFER, submesh.VBO);
-            glBufferData(GL_ARRAY_BUFFER, submesh.vertices.size() * sizeof(Vertex),
-                         &submesh.vertices[0], GL_STATIC_DRAW);
+    // Materiais únicos (por nome) do Mesh, já no layout std140; atribui o
+    // materialIndex de cada SubMesh
+    std::vector<GpuMaterial> buildMaterialTable()
+    {
+        std::vector<GpuMaterial> table;
+        std::unordered_map<std::string, unsigned int> lookup;
+        for (auto &submesh : submeshes)
+        {
+            auto inserted = lookup.emplace(submesh.material.name, (unsigned int)table.size());
+            if (inserted.second)
+            {
+                if (table.size() == IndirectDraw::MAX_MATERIALS)
+                {
+                    std::cout << "WARNING: more than " << IndirectDraw::MAX_MATERIALS
+                              << " materials, using material 0 for " << submesh.material.name << std::endl;
+                    inserted.first->second = 0;
+                }
+                else
+                {
+                    table.push_back(IndirectDraw::gpuMaterial(submesh.material));
+                }
+            }
+            submesh.materialIndex = inserted.first->second;
+        }
+        return table;
+    }
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, submesh.EBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, submesh.indices.size() * sizeof(unsigned int),
-                         &submesh.indices[0], GL_STATIC_DRAW);
+    // LOD a desenhar: currentLod, mas nunca um nível que ainda não chegou à
+    // GPU (os passes carregam do mais simples para o LOD 0)
+    unsigned int drawnLod(const SubMesh &submesh) const
+    {
+        unsigned int lod = std::min(submesh.currentLod, static_cast<unsigned int>(submesh.lods.size() - 1));
+        if (!ready && submesh.lods.size() > loadedPasses)
+            lod = std::max(lod, static_cast<unsigned int>(submesh.lods.size() - std::max<size_t>(loadedPasses, 1)));
+        return lod;
+    }
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+    // Um comando por SubMesh visível com o LOD atual; no LOD 0, um por
+    // sequência de meshlets visíveis seguidos (lista compactada)
+    void updateDrawCommands()
+    {
+        size_t count = 0;
+        size_t backFaceCount = 0; // comandos (visíveis) com back-face culling
+        // só depois de um cullFrustum com os meshlets já construídos
+        const unsigned char *meshletVisible = meshletsCulled ? meshletCuller.visibility() : nullptr;
+        auto emit = [&](const DrawElementsIndirectCommand &command)
+        {
+            if (count < commandScratch.size())
+                commandScratch[count] = command;
+            else
+                commandScratch.push_back(command);
+            ++count;
+        };
 
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                  (void *)offsetof(Vertex, Normal));
+        for (unsigned int index : drawOrder)
+        {
+            const SubMesh &submesh = submeshes[index];
+            if (!submesh.visible)
+                continue;
 
-            glBindVertexArray(0);
+            size_t before = count;
+            unsigned int lodIndex = drawnLod(submesh);
+            if (lodIndex == 0 && meshletVisible && !submesh.meshlets.empty())
+            {
+                const unsigned char *visible = meshletVisible + firstMeshlet[index];
+                for (size_t m = 0; m < submesh.meshlets.size(); ++m)
+                {
+                    if (!visible[m])
+                        continue;
+                    const Meshlet &meshlet = submesh.meshlets[m];
+                    unsigned int firstIndex = submesh.firstIndex + meshlet.firstIndex;
+                    if (count > before &&
+                        commandScratch[count - 1].firstIndex + commandScratch[count - 1].count == firstIndex)
+                        commandScratch[count - 1].count += meshlet.indexCount; // junta ao anterior
+                    else
+                        emit({meshlet.indexCount, 1, firstIndex, (int)submesh.baseVertex, index});
+                }
+            }
+            else
+            {
+                const MeshLod &lod = submesh.lods[lodIndex];
+                emit({lod.indexCount, 1, submesh.firstIndex + lod.indexOffset, (int)submesh.baseVertex, index});
+            }
+            backFaceCount += submesh.cullBackFaces ? count - before : 0;
         }
+        draws.update(commandScratch.data(), count, backFaceCount);
     }
 };
 
@@ -0,0 +1,495 @@
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "mesh_types.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MESH_BVH_SSE 1
+#endif
+
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction; // não precisa de estar normalizada; t é medido nela
+    float tMax = std::numeric_limits<float>::max();
+};
+
+struct RayHit
+{
+    bool hit = false;
+    float t = 0.0f;
+    unsigned int submesh = 0;
+    unsigned int triangle = 0; // índice do triângulo dentro do SubMesh (LOD 0)
+    float u = 0.0f, v = 0.0f;  // baricêntricas
+    glm::vec3 point = glm::vec3(0.0f);
+};
+
+// BVH construída com SAH (binning) sobre os triângulos de LOD 0 de todos os
+// SubMeshes. Os nós ficam num array plano de 32 bytes, com os dois filhos
+// lado a lado (esquerdo em leftFirst, direito em leftFirst + 1). Os
+// triângulos são guardados já pela ordem das folhas como (v0, e1, e2) para
+// o teste de Möller-Trumbore. Triângulos são de dupla face. A profundidade
+// é limitada a MAX_DEPTH (abaixo disso o nó fica folha, com os triângulos
+// que tiver), o que limita a recursão da construção e garante que as pilhas
+// da travessia nunca enchem.
+class MeshBVH
+{
+public:
+    static constexpr unsigned int MAX_LEAF_TRIANGLES = 4;
+    static constexpr int BINS = 16;
+    static constexpr unsigned int MAX_DEPTH = 64;
+
+    void build(const std::vector<SubMesh> &submeshes)
+    {
+        nodes.clear();
+        triangles.clear();
+        references.clear();
+        treeDepth = 0;
+
+        std::vector<BuildTriangle> build;
+        for (unsigned int s = 0; s < submeshes.size(); ++s)
+        {
+            const SubMesh &submesh = submeshes[s];
+            for (unsigned int t = 0; t + 2 < submesh.indices.size(); t += 3)
+            {
+                BuildTriangle b;
+                b.p[0] = submesh.vertices[submesh.indices[t]].Position;
+                b.p[1] = submesh.vertices[submesh.indices[t + 1]].Position;
+                b.p[2] = submesh.vertices[submesh.indices[t + 2]].Position;
+                b.min = glm::min(b.p[0], glm::min(b.p[1], b.p[2]));
+                b.max = glm::max(b.p[0], glm::max(b.p[1], b.p[2]));
+                b.centroid = (b.p[0] + b.p[1] + b.p[2]) / 3.0f;
+                b.submesh = s;
+                b.triangle = t / 3;
+                build.push_back(b);
+            }
+        }
+        if (build.empty())
+            return;
+
+        nodes.reserve(build.size() * 2 / MAX_LEAF_TRIANGLES + 1);
+        nodes.push_back(Node());
+        buildRecursive(build, 0, 0, (unsigned int)build.size(), 0);
+
+        triangles.resize(build.size());
+        references.resize(build.size());
+        for (size_t i = 0; i < build.size(); ++i)
+        {
+            triangles[i] = {build[i].p[0], build[i].p[1] - build[i].p[0], build[i].p[2] - build[i].p[0]};
+            references[i] = {build[i].submesh, build[i].triangle};
+        }
+    }
+
+    bool empty() const { return nodes.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t triangleCount() const { return triangles.size(); }
+    // nível da folha mais funda (raiz = 0), nunca acima de MAX_DEPTH
+    unsigned int depth() const { return treeDepth; }
+
+    bool closestHit(const Ray &ray, RayHit &hit) const
+    {
+        hit = RayHit();
+        if (nodes.empty())
+            return false;
+
+        RayState state(ray);
+        float tBest = ray.tMax;
+        unsigned int best = 0;
+        float bestU = 0.0f, bestV = 0.0f;
+        bool found = false;
+
+        // pilha com a distância de entrada de cada nó adiado: no máximo um
+        // por nível, por isso cabe sempre em STACK_SIZE
+        unsigned int stack[STACK_SIZE];
+        float stackT[STACK_SIZE];
+        int top = 0;
+        unsigned int index = 0;
+        if (intersectNode(nodes[0], state, tBest) == NO_HIT)
+            return false;
+
+        while (true)
+        {
+            const Node &node = nodes[index];
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+                {
+                    float t, u, v;
+                    if (intersectTriangle(triangles[i], ray, t, u, v) && t < tBest)
+                    {
+                        tBest = t;
+                        best = i;
+                        bestU = u;
+                        bestV = v;
+                        found = true;
+                    }
+                }
+            }
+            else
+            {
+                // filho mais próximo primeiro; o outro fica na pilha
+                unsigned int a = node.leftFirst, b = node.leftFirst + 1;
+                float ta = intersectNode(nodes[a], state, tBest);
+                float tb = intersectNode(nodes[b], state, tBest);
+                if (ta > tb)
+                {
+                    std::swap(ta, tb);
+                    std::swap(a, b);
+                }
+                if (ta != NO_HIT)
+                {
+                    if (tb != NO_HIT)
+                    {
+                        stackT[top] = tb;
+                        stack[top++] = b;
+                    }
+                    index = a;
+                    continue;
+                }
+            }
+
+            // próximo nó da pilha que ainda pode ter um hit mais perto
+            bool next = false;
+            while (top > 0)
+            {
+                --top;
+                if (stackT[top] < tBest)
+                {
+                    index = stack[top];
+                    next = true;
+                    break;
+                }
+            }
+            if (!next)
+                break;
+        }
+
+        if (found)
+        {
+            hit.hit = true;
+            hit.t = tBest;
+            hit.submesh = references[best].submesh;
+            hit.triangle = references[best].triangle;
+            hit.u = bestU;
+            hit.v = bestV;
+            hit.point = ray.origin + ray.direction * tBest;
+        }
+        return found;
+    }
+
+    // Pára no primeiro triângulo encontrado (sombras, oclusão)
+    bool anyHit(const Ray &ray) const
+    {
+        if (nodes.empty())
+            return false;
+
+        RayState state(ray);
+        // cada nível tira um nó e põe dois: no máximo profundidade + 1
+        unsigned int stack[STACK_SIZE];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            if (intersectNode(node, state, ray.tMax) == NO_HIT)
+                continue;
+
+            if (node.count > 0)
+            {
+                for (unsigned int i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+                {
+                    float t, u, v;
+                    if (intersectTriangle(triangles[i], ray, t, u, v) && t < ray.tMax)
+                        return true;
+                }
+            }
+            else
+            {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+        return false;
+    }
+
+    // Vários raios de uma vez, repartidos por threads (threadCount = 0 usa
+    // hardware_concurrency); hits[i] corresponde a rays[i]
+    void closestHits(const Ray *rays, size_t count, RayHit *hits, unsigned int threadCount = 0) const
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = (unsigned int)std::min<size_t>(threadCount, (count + MIN_RAYS_PER_THREAD - 1) / MIN_RAYS_PER_THREAD);
+
+        if (threadCount <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                closestHit(rays[i], hits[i]);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        size_t perThread = (count + threadCount - 1) / threadCount;
+        for (unsigned int w = 0; w < threadCount; ++w)
+        {
+            size_t begin = w * perThread, end = std::min(count, begin + perThread);
+            workers.emplace_back([this, rays, hits, begin, end]()
+                                 {
+                for (size_t i = begin; i < end; ++i)
+                    closestHit(rays[i], hits[i]); });
+        }
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+private:
+    static constexpr int STACK_SIZE = MAX_DEPTH + 2;
+    static constexpr size_t MIN_RAYS_PER_THREAD = 1024;
+    static constexpr float NO_HIT = std::numeric_limits<float>::max();
+
+    // 32 bytes: folha se count > 0 (triângulos leftFirst..leftFirst+count),
+    // senão nó interior com filhos leftFirst e leftFirst + 1
+    struct Node
+    {
+        float min[3];
+        unsigned int leftFirst;
+        float max[3];
+        unsigned int count;
+    };
+    static_assert(sizeof(Node) == 32, "nó da BVH deve ter 32 bytes");
+
+    struct Triangle
+    {
+        glm::vec3 v0, e1, e2;
+    };
+
+    struct Reference
+    {
+        unsigned int submesh, triangle;
+    };
+
+    struct BuildTriangle
+    {
+        glm::vec3 p[3];
+        glm::vec3 min, max, centroid;
+        unsigned int submesh, triangle;
+    };
+
+    // Dados do raio pré-calculados para o teste de slabs
+    struct RayState
+    {
+        float origin[4];
+        float invDir[4];
+
+        explicit RayState(const Ray &ray)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                origin[c] = ray.origin[c];
+                // evita 0 * inf = NaN nos slabs paralelos ao raio
+                float d = ray.direction[c];
+                invDir[c] = 1.0f / (std::abs(d) > 1e-20f ? d : (d < 0.0f ? -1e-20f : 1e-20f));
+            }
+            origin[3] = 0.0f;
+            invDir[3] = 0.0f;
+        }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<Reference> references;
+    unsigned int treeDepth = 0;
+
+    struct Bin
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+        unsigned int count = 0;
+
+        void grow(const Bin &other)
+        {
+            if (other.count == 0)
+                return;
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+            count += other.count;
+        }
+    };
+
+    static int binIndex(float centroid, float min, float scale)
+    {
+        return std::min(BINS - 1, (int)((centroid - min) * scale));
+    }
+
+    static float surfaceArea(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        glm::vec3 e = max - min;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    void buildRecursive(std::vector<BuildTriangle> &build, unsigned int nodeIndex, unsigned int first, unsigned int count,
+                        unsigned int depth)
+    {
+        glm::vec3 minB(std::numeric_limits<float>::max()), maxB(-std::numeric_limits<float>::max());
+        glm::vec3 minC = minB, maxC = maxB;
+        for (unsigned int i = first; i < first + count; ++i)
+        {
+            minB = glm::min(minB, build[i].min);
+            maxB = glm::max(maxB, build[i].max);
+            minC = glm::min(minC, build[i].centroid);
+            maxC = glm::max(maxC, build[i].centroid);
+        }
+
+        Node &node = nodes[nodeIndex];
+        for (int c = 0; c < 3; ++c)
+        {
+            node.min[c] = minB[c];
+            node.max[c] = maxB[c];
+        }
+        node.leftFirst = first;
+        node.count = count;
+        treeDepth = std::max(treeDepth, depth);
+        if (count <= 1 || depth >= MAX_DEPTH)
+            return;
+
+        // Melhor divisão SAH em BINS intervalos por eixo; os três eixos são
+        // preenchidos na mesma passagem pelos triângulos
+        Bin bins[3][BINS];
+        glm::vec3 scale(0.0f);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float extent = maxC[axis] - minC[axis];
+            scale[axis] = extent > 0.0f ? BINS / extent : 0.0f;
+        }
+        for (unsigned int i = first; i < first + count; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                Bin &bin = bins[axis][binIndex(build[i].centroid[axis], minC[axis], scale[axis])];
+                bin.count++;
+                bin.min = glm::min(bin.min, build[i].min);
+                bin.max = glm::max(bin.max, build[i].max);
+            }
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1, bestSplit = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (scale[axis] == 0.0f)
+                continue;
+
+            // varrimento da direita (custos acumulados), depois da esquerda
+            float rightArea[BINS - 1];
+            unsigned int rightCount[BINS - 1];
+            Bin right;
+            for (int b = BINS - 1; b > 0; --b)
+            {
+                right.grow(bins[axis][b]);
+                rightCount[b - 1] = right.count;
+                rightArea[b - 1] = right.count ? surfaceArea(right.min, right.max) : 0.0f;
+            }
+
+            Bin left;
+            for (int s = 0; s < BINS - 1; ++s)
+            {
+                left.grow(bins[axis][s]);
+                if (left.count == 0 || rightCount[s] == 0)
+                    continue;
+                float cost = left.count * surfaceArea(left.min, left.max) + rightCount[s] * rightArea[s];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = s;
+                }
+            }
+        }
+
+        // Folha se não há divisão possível ou se, com poucos triângulos,
+        // dividir custa mais do que testá-los todos (travessia ~ 1 triângulo)
+        float area = surfaceArea(minB, maxB);
+        if (bestAxis < 0 || (count <= MAX_LEAF_TRIANGLES && area + bestCost >= count * area))
+            return;
+
+        float splitMin = minC[bestAxis], splitScale = scale[bestAxis];
+        auto middle = std::partition(build.begin() + first, build.begin() + first + count,
+                                     [&](const BuildTriangle &t)
+                                     { return binIndex(t.centroid[bestAxis], splitMin, splitScale) <= bestSplit; });
+        unsigned int leftCountFinal = (unsigned int)(middle - (build.begin() + first));
+        if (leftCountFinal == 0 || leftCountFinal == count)
+            return;
+
+        unsigned int left = (unsigned int)nodes.size();
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        nodes[nodeIndex].leftFirst = left;
+        nodes[nodeIndex].count = 0;
+
+        buildRecursive(build, left, first, leftCountFinal, depth + 1);
+        buildRecursive(build, left + 1, first + leftCountFinal, count - leftCountFinal, depth + 1);
+    }
+
+    // Distância de entrada na caixa, ou NO_HIT
+    static float intersectNode(const Node &node, const RayState &ray, float tMax)
+    {
+#ifdef MESH_BVH_SSE
+        __m128 o = _mm_loadu_ps(ray.origin);
+        __m128 inv = _mm_loadu_ps(ray.invDir);
+        // a quarta componente (leftFirst/count) é lixo e nunca é lida
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.min), o), inv);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.max), o), inv);
+        __m128 tNear = _mm_min_ps(t1, t2);
+        __m128 tFar = _mm_max_ps(t1, t2);
+
+        float n[4], f[4];
+        _mm_storeu_ps(n, tNear);
+        _mm_storeu_ps(f, tFar);
+        float tEnter = std::max(std::max(n[0], n[1]), std::max(n[2], 0.0f));
+        float tExit = std::min(std::min(f[0], f[1]), std::min(f[2], tMax));
+#else
+        float tEnter = 0.0f, tExit = tMax;
+        for (int c = 0; c < 3; ++c)
+        {
+            float t1 = (node.min[c] - ray.origin[c]) * ray.invDir[c];
+            float t2 = (node.max[c] - ray.origin[c]) * ray.invDir[c];
+            tEnter = std::max(tEnter, std::min(t1, t2));
+            tExit = std::min(tExit, std::max(t1, t2));
+        }
+#endif
+        return tEnter <= tExit ? tEnter : NO_HIT;
+    }
+
+    // Möller-Trumbore, sem culling
+    static bool intersectTriangle(const Triangle &tri, const Ray &ray, float &t, float &u, float &v)
+    {
+        glm::vec3 p = glm::cross(ray.direction, tri.e2);
+        float det = glm::dot(tri.e1, p);
+        if (std::abs(det) < 1e-12f)
+            return false;
+
+        float invDet = 1.0f / det;
+        glm::vec3 s = ray.origin - tri.v0;
+        u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        glm::vec3 q = glm::cross(s, tri.e1);
+        v = glm::dot(ray.direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        t = glm::dot(tri.e2, q) * invDet;
+        return t >= 0.0f;
+    }
+};
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_types.h"
+
+// Cache binário (.boatmesh) com os arrays finais de vértices/índices de cada
+// SubMesh e o respetivo material. A chave é um hash do conteúdo do OBJ e do
+// MTL, por isso uma cache desatualizada é detetada e reconstruída. O
+// cabeçalho guarda também o tamanho e a data dos ficheiros de origem, para
+// abrir a cache sem ler o OBJ inteiro quando não mudaram (storedHash).
+//
+// Layout (little-endian, offsets absolutos alinhados a 16 bytes):
+//   Header | SubmeshRecord[submeshCount] | nomes dos materiais |
+//   LodRecord[] | dados
+// O bloco de índices de cada SubMesh é o conteúdo completo do EBO (LOD 0
+// seguido dos restantes LODs). Os vértices vêm ordenados do LOD mais simples
+// para o mais detalhado (ver MeshLod::vertexCount) e os volumes envolventes
+// vêm nos registos, por isso um nível simples pode ser desenhado antes de o
+// resto do ficheiro ser lido.
+class MeshCache
+{
+public:
+    static constexpr uint32_t VERSION = 5;
+
+    // Tamanho e data de modificação do OBJ e do MTL (0 se não existirem)
+    struct SourceStamp
+    {
+        uint64_t objSize, objTime;
+        uint64_t mtlSize, mtlTime;
+
+        static SourceStamp of(const std::string &objPath, const std::string &mtlPath)
+        {
+            SourceStamp stamp = {};
+            stat(objPath, stamp.objSize, stamp.objTime);
+            stat(mtlPath, stamp.mtlSize, stamp.mtlTime);
+            return stamp;
+        }
+
+        bool operator==(const SourceStamp &o) const
+        {
+            return objSize == o.objSize && objTime == o.objTime && mtlSize == o.mtlSize && mtlTime == o.mtlTime;
+        }
+
+    private:
+        static void stat(const std::string &path, uint64_t &size, uint64_t &time)
+        {
+            std::error_code ec;
+            uintmax_t bytes = std::filesystem::file_size(path, ec);
+            if (ec)
+                return;
+            auto written = std::filesystem::last_write_time(path, ec);
+            if (ec)
+                return;
+            size = static_cast<uint64_t>(bytes);
+            time = static_cast<uint64_t>(written.time_since_epoch().count());
+        }
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t submeshCount;
+        uint64_t sourceHash;
+        uint32_t vertexSize;
+        float radius; // esfera de todo o Mesh, centrada na AABB dos SubMeshes
+        SourceStamp sources;
+    };
+
+    struct SubmeshRecord
+    {
+        uint64_t vertexOffset;
+        uint64_t vertexCount;
+        uint64_t indexOffset;
+        uint64_t indexCount;
+        float ambient[3];
+        float diffuse[3];
+        float specular[3];
+        float shininess;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t lodOffset;
+        uint32_t lodCount;
+        uint32_t flags;
+        float boundsMin[3];
+        float boundsMax[3];
+        float radius;
+        uint32_t reserved;
+    };
+
+    static constexpr uint32_t FLAG_CULL_BACK_FACES = 1;
+
+    struct LodRecord
+    {
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        float error;
+        uint32_t vertexCount;
+    };
+
+    static_assert(sizeof(Header) == 64, "Header do .boatmesh mudou de tamanho");
+    static_assert(sizeof(SubmeshRecord) == 128, "SubmeshRecord do .boatmesh mudou de tamanho");
+    static_assert(sizeof(LodRecord) == 16, "LodRecord do .boatmesh mudou de tamanho");
+    static_assert(sizeof(Vertex) == 24, "Vertex deve ser 2 x vec3 sem padding");
+
+    // Vista sobre um SubMesh dentro do ficheiro mapeado
+    struct CachedSubmesh
+    {
+        Material material;
+        const Vertex *vertices;
+        size_t vertexCount;
+        const unsigned int *indices;
+        size_t indexCount;
+        std::vector<MeshLod> lods;
+        Bounds bounds;
+        bool cullBackFaces;
+    };
+
+    static std::string cachePath(const std::string &objPath)
+    {
+        return objPath.substr(0, objPath.find_last_of('.')) + ".boatmesh";
+    }
+
+    static uint64_t hashBytes(const char *data, size_t size, uint64_t seed)
+    {
+        const uint64_t k1 = 0x9E3779B185EBCA87ull;
+        const uint64_t k2 = 0xC2B2AE3D27D4EB4Full;
+        uint64_t h = seed ^ (size * k1);
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t w;
+            std::memcpy(&w, data + i, 8);
+            h ^= w * k2;
+            h = ((h << 31) | (h >> 33)) * k1;
+        }
+        for (; i < size; ++i)
+            h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001B3ull;
+
+        h ^= h >> 33;
+        h *= k2;
+        h ^= h >> 29;
+        return h;
+    }
+
+    // Hash do OBJ + MTL; 0 se o OBJ não existir
+    static uint64_t hashSources(const std::string &objPath, const std::string &mtlPath)
+    {
+        MappedFile obj(objPath.c_str());
+        if (!obj.isOpen())
+            return 0;
+
+        uint64_t h = hashBytes(obj.data(), obj.size(), VERSION);
+        MappedFile mtl(mtlPath.c_str());
+        if (mtl.isOpen())
+            h = hashBytes(mtl.data(), mtl.size(), h);
+        return h != 0 ? h : 1;
+    }
+
+    // Hash guardado na cache se os ficheiros de origem têm o mesmo tamanho e
+    // a mesma data de quando foi escrita; 0 (calcular com hashSources) se
+    // não. Uma edição que mantenha os dois passa despercebida, como no make.
+    static uint64_t storedHash(const std::string &path, const SourceStamp &stamp)
+    {
+        std::ifstream file(path, std::ios::binary);
+        Header header;
+        if (stamp.objSize == 0 || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            return 0;
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != VERSION || header.vertexSize != sizeof(Vertex) || !(header.sources == stamp))
+            return 0;
+        return header.sourceHash;
+    }
+
+    // Valida o ficheiro e devolve vistas sobre os dados (válidas enquanto o
+    // MappedFile estiver aberto) e a esfera de todo o Mesh
+    static bool read(const MappedFile &file, uint64_t sourceHash, std::vector<CachedSubmesh> &out, float &radius)
+    {
+        out.clear();
+        if (!file.isOpen() || file.size() < sizeof(Header))
+            return false;
+
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != VERSION || header.sourceHash != sourceHash ||
+            header.vertexSize != sizeof(Vertex))
+            return false;
+        radius = header.radius;
+
+        uint64_t recordsEnd = sizeof(Header) + uint64_t(header.submeshCount) * sizeof(SubmeshRecord);
+        if (recordsEnd > file.size())
+            return false;
+
+        const SubmeshRecord *records = reinterpret_cast<const SubmeshRecord *>(file.data() + sizeof(Header));
+        for (uint32_t i = 0; i < header.submeshCount; ++i)
+        {
+            const SubmeshRecord &r = records[i];
+            if (r.vertexCount > file.size() || r.indexCount > file.size() ||
+                !inBounds(file, r.vertexOffset, r.vertexCount * sizeof(Vertex)) ||
+                !inBounds(file, r.indexOffset, r.indexCount * sizeof(unsigned int)) ||
+                !inBounds(file, r.nameOffset, r.nameLength) ||
+                r.lodCount == 0 || r.lodCount > file.size() ||
+                !inBounds(file, r.lodOffset, uint64_t(r.lodCount) * sizeof(LodRecord)))
+                return false;
+
+            // um índice fora dos vértices faria o GPU ler fora do VBO
+            const unsigned int *indices = reinterpret_cast<const unsigned int *>(file.data() + r.indexOffset);
+            for (uint64_t k = 0; k < r.indexCount; ++k)
+                if (indices[k] >= r.vertexCount)
+                    return false;
+
+            CachedSubmesh submesh;
+            submesh.material.name.assign(file.data() + r.nameOffset, r.nameLength);
+            submesh.material.ambient = glm::vec3(r.ambient[0], r.ambient[1], r.ambient[2]);
+            submesh.material.diffuse = glm::vec3(r.diffuse[0], r.diffuse[1], r.diffuse[2]);
+            submesh.material.specular = glm::vec3(r.specular[0], r.specular[1], r.specular[2]);
+            submesh.material.shininess = r.shininess;
+            submesh.vertices = reinterpret_cast<const Vertex *>(file.data() + r.vertexOffset);
+            submesh.vertexCount = static_cast<size_t>(r.vertexCount);
+            submesh.indices = indices;
+            submesh.indexCount = static_cast<size_t>(r.indexCount);
+            submesh.cullBackFaces = (r.flags & FLAG_CULL_BACK_FACES) != 0;
+            submesh.bounds = Bounds::fromBox(glm::vec3(r.boundsMin[0], r.boundsMin[1], r.boundsMin[2]),
+                                             glm::vec3(r.boundsMax[0], r.boundsMax[1], r.boundsMax[2]));
+            submesh.bounds.radius = r.radius;
+
+            const LodRecord *lods = reinterpret_cast<const LodRecord *>(file.data() + r.lodOffset);
+            for (uint32_t l = 0; l < r.lodCount; ++l)
+            {
+                // cada nível usa um prefixo dos vértices, contido no do
+                // anterior, e os índices dos níveis >= 1 vêm depois dos do 0
+                uint64_t previousVertices = l > 0 ? lods[l - 1].vertexCount : r.vertexCount;
+                if (uint64_t(lods[l].indexOffset) + lods[l].indexCount > r.indexCount ||
+                    lods[l].vertexCount > previousVertices ||
+                    (l > 0 && lods[l].indexOffset < lods[0].indexCount))
+                    return false;
+                submesh.lods.push_back({lods[l].indexOffset, lods[l].indexCount, lods[l].error, lods[l].vertexCount});
+            }
+            if (submesh.lods[0].indexOffset != 0 || submesh.lods[0].vertexCount != r.vertexCount)
+                return false;
+            out.push_back(std::move(submesh));
+        }
+        return true;
+    }
+
+    // Escreve para um ficheiro temporário e renomeia, para nunca deixar uma
+    // cache meio escrita
+    static bool write(const std::string &path, uint64_t sourceHash, const SourceStamp &sources,
+                      float radius, const std::vector<SubMesh> &submeshes)
+    {
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.submeshCount = static_cast<uint32_t>(submeshes.size());
+        header.sourceHash = sourceHash;
+        header.vertexSize = sizeof(Vertex);
+        header.radius = radius;
+        header.sources = sources;
+
+        std::vector<SubmeshRecord> records(submeshes.size());
+        std::string names;
+        uint64_t offset = sizeof(Header) + records.size() * sizeof(SubmeshRecord);
+
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            const Material &m = submeshes[i].material;
+            SubmeshRecord &r = records[i];
+            r = {};
+            r.nameOffset = static_cast<uint32_t>(offset + names.size());
+            r.nameLength = static_cast<uint32_t>(m.name.size());
+            names += m.name;
+            std::memcpy(r.ambient, &m.ambient[0], sizeof(r.ambient));
+            std::memcpy(r.diffuse, &m.diffuse[0], sizeof(r.diffuse));
+            std::memcpy(r.specular, &m.specular[0], sizeof(r.specular));
+            r.shininess = m.shininess;
+            r.flags = submeshes[i].cullBackFaces ? FLAG_CULL_BACK_FACES : 0;
+            const Bounds &b = submeshes[i].bounds;
+            std::memcpy(r.boundsMin, &b.min[0], sizeof(r.boundsMin));
+            std::memcpy(r.boundsMax, &b.max[0], sizeof(r.boundsMax));
+            r.radius = b.radius;
+        }
+        offset = align(offset + names.size());
+
+        std::vector<LodRecord> lods;
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            records[i].lodOffset = offset + lods.size() * sizeof(LodRecord);
+            records[i].lodCount = static_cast<uint32_t>(submeshes[i].lods.size());
+            for (const MeshLod &lod : submeshes[i].lods)
+                lods.push_back({lod.indexOffset, lod.indexCount, lod.error, lod.vertexCount});
+        }
+        offset = align(offset + lods.size() * sizeof(LodRecord));
+
+        for (size_t i = 0; i < submeshes.size(); ++i)
+        {
+            records[i].vertexOffset = offset;
+            records[i].vertexCount = submeshes[i].vertices.size();
+            offset = align(offset + submeshes[i].vertices.size() * sizeof(Vertex));
+
+            records[i].indexOffset = offset;
+            records[i].indexCount = submeshes[i].indices.size() + submeshes[i].lodIndices.size();
+            offset = align(offset + records[i].indexCount * sizeof(unsigned int));
+        }
+
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return false;
+
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(SubmeshRecord));
+            file.write(names.data(), names.size());
+            pad(file, records.empty() ? offset : records[0].lodOffset);
+            file.write(reinterpret_cast<const char *>(lods.data()), lods.size() * sizeof(LodRecord));
+            for (size_t i = 0; i < submeshes.size(); ++i)
+            {
+                pad(file, records[i].vertexOffset);
+                file.write(reinterpret_cast<const char *>(submeshes[i].vertices.data()),
+                           submeshes[i].vertices.size() * sizeof(Vertex));
+                pad(file, records[i].indexOffset);
+                file.write(reinterpret_cast<const char *>(submeshes[i].indices.data()),
+                           submeshes[i].indices.size() * sizeof(unsigned int));
+                file.write(reinterpret_cast<const char *>(submeshes[i].lodIndices.data()),
+                           submeshes[i].lodIndices.size() * sizeof(unsigned int));
+            }
+            pad(file, offset);
+            if (!file.good())
+                return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(tmpPath, ignored);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'B', 'O', 'A', 'T', 'M', 'S', 'H', '\0'};
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + 15) & ~uint64_t(15);
+    }
+
+    static void pad(std::ofstream &file, uint64_t offset)
+    {
+        static const char zeros[16] = {};
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        if (offset > position)
+            file.write(zeros, static_cast<std::streamsize>(offset - position));
+    }
+
+    static bool inBounds(const MappedFile &file, uint64_t offset, uint64_t bytes)
+    {
+        return offset <= file.size() && bytes <= file.size() - offset;
+    }
+};
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mesh_types.h"
+
+// Reordenação de índices/vértices para a cache pós-transformação, overdraw e
+// localidade de leitura dos vértices. Os algoritmos seguem:
+//  - cache:    Forsyth, "Linear-Speed Vertex Cache Optimisation"
+//  - overdraw: Sander et al., "Fast Triangle Reordering for Vertex Locality
+//              and Reduced Overdraw" (clusters ordenados pela orientação)
+class MeshOptimizer
+{
+public:
+    // Tamanho da cache FIFO usada nas estatísticas (hardware típico: 16-32)
+    static constexpr unsigned int STATS_CACHE_SIZE = 16;
+
+    struct CacheStats
+    {
+        float acmr = 0.0f; // vértices transformados por triângulo
+        float atvr = 0.0f; // vértices transformados por vértice único
+    };
+
+    static CacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount,
+                                         unsigned int cacheSize = STATS_CACHE_SIZE)
+    {
+        CacheStats stats;
+        if (indices.empty() || vertexCount == 0)
+            return stats;
+
+        // FIFO: um vértice está na cache se foi inserido há menos de cacheSize misses
+        std::vector<size_t> timestamps(vertexCount, 0);
+        size_t time = cacheSize + 1;
+        size_t misses = 0;
+        for (unsigned int v : indices)
+        {
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+
+        size_t used = 0;
+        for (size_t t : timestamps)
+            used += (t != 0);
+
+        stats.acmr = float(misses) / float(indices.size() / 3);
+        stats.atvr = float(misses) / float(std::max<size_t>(used, 1));
+        return stats;
+    }
+
+    // Forsyth: escolhe sempre o triângulo com maior pontuação entre os que
+    // tocam vértices na cache LRU simulada
+    static void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount)
+    {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // Adjacência vértice -> triângulos (CSR)
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (unsigned int v : indices)
+            offsets[v + 1]++;
+        for (size_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] += offsets[v];
+
+        std::vector<unsigned int> adjacency(indices.size());
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+        std::vector<unsigned int> liveTriangles(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            liveTriangles[v] = offsets[v + 1] - offsets[v];
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vertexScore[v] = scoreVertex(-1, liveTriangles[v]);
+
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t)
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+        std::vector<char> emitted(triangleCount, 0);
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+
+        std::vector<unsigned int> cache, newCache;
+        cache.reserve(CACHE_SIZE + 3);
+        newCache.reserve(CACHE_SIZE + 3);
+
+        size_t cursor = 0; // próximo triângulo candidato quando a cache não ajuda
+        long best = -1;
+
+        while (result.size() < indices.size())
+        {
+            if (best < 0)
+            {
+                // Sem candidatos na cache: o primeiro triângulo livre a partir
+                // do cursor (linear no total, porque o cursor só avança)
+                while (cursor < triangleCount && emitted[cursor])
+                    ++cursor;
+                if (cursor == triangleCount)
+                    break;
+                best = static_cast<long>(cursor);
+            }
+
+            unsigned int t = static_cast<unsigned int>(best);
+            emitted[t] = 1;
+            const unsigned int *tri = &indices[t * 3];
+            result.insert(result.end(), tri, tri + 3);
+
+            // Triângulo emitido sai das listas de adjacência dos seus vértices
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int v = tri[k];
+                unsigned int *begin = &adjacency[offsets[v]];
+                unsigned int *end = begin + liveTriangles[v];
+                unsigned int *it = std::find(begin, end, t);
+                if (it != end)
+                {
+                    std::swap(*it, *(end - 1));
+                    liveTriangles[v]--;
+                }
+            }
+
+            // LRU: vértices do triângulo à frente, restantes empurrados
+            newCache.clear();
+            newCache.insert(newCache.end(), tri, tri + 3);
+            for (unsigned int v : cache)
+            {
+                if (v != tri[0] && v != tri[1] && v != tri[2])
+                    newCache.push_back(v);
+            }
+            for (size_t i = CACHE_SIZE; i < newCache.size(); ++i)
+                cachePosition[newCache[i]] = -1; // saiu da cache
+            if (newCache.size() > CACHE_SIZE)
+                newCache.resize(CACHE_SIZE);
+            cache.swap(newCache);
+
+            // Atualizar pontuações dos vértices na cache e dos seus triângulos
+            for (size_t i = 0; i < cache.size(); ++i)
+            {
+                cachePosition[cache[i]] = static_cast<int>(i);
+            }
+            for (unsigned int v : newCache)
+            {
+                if (cachePosition[v] < 0)
+                    refreshVertex(v, adjacency, offsets, liveTriangles, cachePosition, vertexScore, triangleScore);
+            }
+
+            best = -1;
+            float bestScore = -1.0f;
+            for (unsigned int v : cache)
+            {
+                refreshVertex(v, adjacency, offsets, liveTriangles, cachePosition, vertexScore, triangleScore);
+            }
+            for (unsigned int v : cache)
+            {
+                for (unsigned int i = 0; i < liveTriangles[v]; ++i)
+                {
+                    unsigned int candidate = adjacency[offsets[v] + i];
+                    if (triangleScore[candidate] > bestScore)
+                    {
+                        bestScore = triangleScore[candidate];
+                        best = candidate;
+                    }
+                }
+            }
+        }
+
+        indices.swap(result);
+    }
+
+    // Divide a sequência (já otimizada para a cache) em clusters e ordena-os
+    // para que os virados "para fora" sejam desenhados primeiro. threshold
+    // limita o aumento de ACMR permitido ao partir clusters.
+    static void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices,
+                                 float threshold = 1.05f)
+    {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2)
+            return;
+
+        // Fronteiras fortes: triângulos cujos 3 vértices falham a cache
+        std::vector<unsigned int> misses(triangleCount);
+        std::vector<size_t> timestamps(vertices.size(), 0);
+        size_t time = STATS_CACHE_SIZE + 1;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            unsigned int m = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int v = indices[t * 3 + k];
+                if (time - timestamps[v] > STATS_CACHE_SIZE)
+                {
+                    timestamps[v] = time++;
+                    m++;
+                }
+            }
+            misses[t] = m;
+        }
+
+        std::vector<size_t> hard{0};
+        for (size_t t = 1; t < triangleCount; ++t)
+        {
+            if (misses[t] == 3)
+                hard.push_back(t);
+        }
+        hard.push_back(triangleCount);
+
+        // Fronteiras suaves: partir um cluster forte sempre que o ACMR do
+        // troço atual fica dentro do limite do ACMR do cluster inteiro
+        std::vector<size_t> clusters;
+        for (size_t c = 0; c + 1 < hard.size(); ++c)
+        {
+            size_t start = hard[c], end = hard[c + 1];
+            size_t clusterMisses = 0;
+            for (size_t t = start; t < end; ++t)
+                clusterMisses += misses[t];
+            float limit = float(clusterMisses) / float(end - start) * threshold;
+
+            clusters.push_back(start);
+            size_t subStart = start, subMisses = 0;
+            for (size_t t = start; t < end; ++t)
+            {
+                subMisses += misses[t];
+                size_t size = t + 1 - subStart;
+                if (size >= MIN_CLUSTER && t + 1 < end && float(subMisses) / float(size) <= limit)
+                {
+                    clusters.push_back(t + 1);
+                    subStart = t + 1;
+                    subMisses = 0;
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // Centróide da malha (ponderado pela área)
+        glm::vec3 meshCentroid(0.0f);
+        float meshArea = 0.0f;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            glm::vec3 c, n;
+            float area = triangleInfo(indices, vertices, t, c, n);
+            meshCentroid += c * area;
+            meshArea += area;
+        }
+        meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+        struct Cluster
+        {
+            size_t start, end;
+            float key;
+        };
+        std::vector<Cluster> sorted;
+        sorted.reserve(clusters.size() - 1);
+        for (size_t c = 0; c + 1 < clusters.size(); ++c)
+        {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+            {
+                glm::vec3 tc, tn;
+                float a = triangleInfo(indices, vertices, t, tc, tn);
+                centroid += tc * a;
+                normal += tn * a;
+                area += a;
+            }
+            centroid = area > 0.0f ? centroid / area : centroid;
+            float len = glm::length(normal);
+            normal = len > 0.0f ? normal / len : normal;
+            sorted.push_back({clusters[c], clusters[c + 1], glm::dot(centroid - meshCentroid, normal)});
+        }
+
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const Cluster &a, const Cluster &b)
+                         { return a.key > b.key; });
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        for (const Cluster &c : sorted)
+            result.insert(result.end(), indices.begin() + c.start * 3, indices.begin() + c.end * 3);
+        indices.swap(result);
+    }
+
+    // Reordena os vértices pela ordem do primeiro uso no índice
+    static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+    {
+        const unsigned int unused = ~0u;
+        std::vector<unsigned int> remap(vertices.size(), unused);
+        std::vector<Vertex> result;
+        result.reserve(vertices.size());
+
+        for (unsigned int &v : indices)
+        {
+            if (remap[v] == unused)
+            {
+                remap[v] = static_cast<unsigned int>(result.size());
+                result.push_back(vertices[v]);
+            }
+            v = remap[v];
+        }
+        vertices.swap(result);
+    }
+
+private:
+    static constexpr unsigned int CACHE_SIZE = 32;
+    static constexpr size_t MIN_CLUSTER = 16;
+
+    static float scoreVertex(int cachePosition, unsigned int liveTriangles)
+    {
+        if (liveTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // Os 3 últimos vértices pertencem ao triângulo acabado de emitir
+            if (cachePosition < 3)
+                score = 0.75f;
+            else
+                score = std::pow(1.0f - float(cachePosition - 3) / float(CACHE_SIZE - 3), 1.5f);
+        }
+
+        // Favorece vértices com poucos triângulos por emitir
+        return score + 2.0f / std::sqrt(float(liveTriangles));
+    }
+
+    static void refreshVertex(unsigned int v, const std::vector<unsigned int> &adjacency, const std::vector<unsigned int> &offsets,
+                              const std::vector<unsigned int> &liveTriangles, const std::vector<int> &cachePosition,
+                              std::vector<float> &vertexScore, std::vector<float> &triangleScore)
+    {
+        float score = scoreVertex(cachePosition[v], liveTriangles[v]);
+        float delta = score - vertexScore[v];
+        if (delta == 0.0f)
+            return;
+
+        vertexScore[v] = score;
+        for (unsigned int i = 0; i < liveTriangles[v]; ++i)
+            triangleScore[adjacency[offsets[v] + i]] += delta;
+    }
+
+    static float triangleInfo(const std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices,
+                              size_t t, glm::vec3 &centroid, glm::vec3 &normal)
+    {
+        const glm::vec3 &a = vertices[indices[t * 3]].Position;
+        const glm::vec3 &b = vertices[indices[t * 3 + 1]].Position;
+        const glm::vec3 &c = vertices[indices[t * 3 + 2]].Position;
+
+        centroid = (a + b + c) / 3.0f;
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+        return length * 0.5f;
+    }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef MESH_REGISTRY_H
+#define MESH_REGISTRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "mesh.h"
+#include "mesh_cache.h"
+#include "staging_ring.h"
+
+// Meshes partilhados e contados por referência. acquire() devolve o mesmo
+// Mesh (um só parsing e um só conjunto de buffers de GL) para o mesmo
+// conteúdo: a chave é o caminho canónico mais o hash do OBJ e do MTL, por
+// isso cópias do mesmo modelo com outro nome também são partilhadas e um
+// ficheiro alterado no disco dá um Mesh novo. O registo só guarda
+// referências fracas; os buffers são libertados quando o último
+// shared_ptr desaparece, no thread que o larga (tem de ser o de GL).
+//
+// O estado por instância (visibilidade, LOD, comandos indiretos) vive no
+// Mesh: para desenhar várias instâncias chamar cullFrustum/selectLod/Draw
+// para cada uma, em sequência. Usar só no thread de GL.
+class MeshRegistry
+{
+public:
+    MeshRegistry() = default;
+    MeshRegistry(const MeshRegistry &) = delete;
+    MeshRegistry &operator=(const MeshRegistry &) = delete;
+
+    std::shared_ptr<Mesh> acquire(const std::string &path, bool quantizeVertices = false,
+                                  MeshLoadMode mode = MeshLoadMode::Blocking)
+    {
+        std::error_code ec;
+        std::string canonical = std::filesystem::weakly_canonical(path, ec).generic_string();
+        if (ec)
+            canonical = path;
+        std::string mtlPath = canonical.substr(0, canonical.find_last_of('.')) + ".mtl";
+
+        // O hash só é recalculado quando o tamanho ou a data dos ficheiros
+        // mudam, e nem então se a cache em disco foi escrita com os mesmos
+        PathEntry &entry = paths[canonical];
+        MeshCache::SourceStamp stamp = MeshCache::SourceStamp::of(canonical, mtlPath);
+        if (entry.hash == 0 || !(entry.stamp == stamp))
+        {
+            entry.stamp = stamp;
+            entry.hash = MeshCache::storedHash(MeshCache::cachePath(canonical), stamp);
+            if (entry.hash == 0)
+                entry.hash = MeshCache::hashSources(canonical, mtlPath);
+        }
+
+        // Sem hash (ficheiro em falta): Mesh próprio, não partilhado
+        if (entry.hash == 0)
+        {
+            paths.erase(canonical);
+            return std::make_shared<Mesh>(path.c_str(), quantizeVertices, mode);
+        }
+
+        // O mesmo conteúdo com e sem quantização são buffers diferentes
+        uint64_t key = entry.hash ^ (quantizeVertices ? 0x9E3779B97F4A7C15ull : 0);
+        std::shared_ptr<Mesh> mesh = meshes[key].lock();
+        if (mesh)
+        {
+            sharedCount++;
+            return mesh;
+        }
+
+        collect();
+        mesh = std::make_shared<Mesh>(path.c_str(), quantizeVertices, mode);
+        meshes[key] = mesh;
+        loadCount++;
+        return mesh;
+    }
+
+    // Upload dos Meshes assíncronos ainda por acabar, com budgetMs para
+    // todos juntos (pelo menos um bloco por frame)
+    void update(double budgetMs = Mesh::UPLOAD_BUDGET_MS, StagingRing *ring = nullptr)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (auto &item : meshes)
+        {
+            std::shared_ptr<Mesh> mesh = item.second.lock();
+            if (!mesh || mesh->isReady())
+                continue;
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double remaining = budgetMs - elapsed.count();
+            if (remaining <= 0.0)
+                break;
+            mesh->update(remaining, ring);
+        }
+    }
+
+    // Meshes com pelo menos um handle vivo
+    size_t liveCount() const
+    {
+        size_t count = 0;
+        for (const auto &item : meshes)
+            count += item.second.expired() ? 0 : 1;
+        return count;
+    }
+
+    // Meshes criados (parsing e upload) e pedidos servidos por um já existente
+    size_t loads() const { return loadCount; }
+    size_t shared() const { return sharedCount; }
+
+private:
+    struct PathEntry
+    {
+        MeshCache::SourceStamp stamp = {};
+        uint64_t hash = 0;
+    };
+
+    std::unordered_map<std::string, PathEntry> paths;         // caminho canónico -> hash do conteúdo
+    std::unordered_map<uint64_t, std::weak_ptr<Mesh>> meshes; // conteúdo -> Mesh
+    size_t loadCount = 0, sharedCount = 0;
+
+    // Esquece os Meshes já libertados
+    void collect()
+    {
+        for (auto it = meshes.begin(); it != meshes.end();)
+            it = it->second.expired() ? meshes.erase(it) : std::next(it);
+    }
+};
+
+#endif
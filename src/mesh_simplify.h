@@ -0,0 +1,339 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_types.h"
+
+// Simplificação por colapso de arestas com métricas de erro quádricas
+// (Garland & Heckbert). Cada aresta colapsa para um dos extremos, por isso o
+// resultado é só um novo índice sobre os vértices originais.
+//
+// A topologia é construída sobre posições (vértices com a mesma posição e
+// normais diferentes são o mesmo nó), e os vértices na fronteira do SubMesh
+// ficam fixos: é aí que um material encontra outro, e assim os LODs de
+// submeshes vizinhos continuam a encaixar sem fendas.
+class MeshSimplifier
+{
+public:
+    // Devolve o novo índice e, em error, o desvio geométrico estimado (nas
+    // unidades do modelo) em relação à entrada
+    static std::vector<unsigned int> simplify(const std::vector<Vertex> &vertices,
+                                              const std::vector<unsigned int> &indices,
+                                              size_t targetIndexCount, float &error)
+    {
+        error = 0.0f;
+
+        // Nós = posições únicas; wedges = vértices que partilham cada posição
+        std::vector<unsigned int> node(vertices.size());
+        std::vector<glm::vec3> positions;
+        {
+            std::unordered_map<PositionKey, unsigned int, PositionHash> lookup;
+            lookup.reserve(vertices.size());
+            for (size_t v = 0; v < vertices.size(); ++v)
+            {
+                auto inserted = lookup.emplace(PositionKey(vertices[v].Position), (unsigned int)positions.size());
+                if (inserted.second)
+                    positions.push_back(vertices[v].Position);
+                node[v] = inserted.first->second;
+            }
+        }
+        size_t nodeCount = positions.size();
+
+        std::vector<unsigned int> tris;
+        tris.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            unsigned int a = node[indices[i]], b = node[indices[i + 1]], c = node[indices[i + 2]];
+            if (a != b && b != c && a != c)
+                tris.insert(tris.end(), {a, b, c});
+        }
+
+        std::vector<char> locked(nodeCount, 0);
+        lockBorders(tris, locked);
+
+        std::vector<Quadric> quadrics(nodeCount);
+        for (size_t i = 0; i < tris.size(); i += 3)
+        {
+            Quadric q = Quadric::fromTriangle(positions[tris[i]], positions[tris[i + 1]], positions[tris[i + 2]]);
+            for (int k = 0; k < 3; ++k)
+                quadrics[tris[i + k]].add(q);
+        }
+
+        std::vector<unsigned int> remap(nodeCount);
+        double maxError = 0.0;
+
+        while (tris.size() > targetIndexCount)
+        {
+            for (size_t n = 0; n < nodeCount; ++n)
+                remap[n] = static_cast<unsigned int>(n);
+
+            size_t collapses = collapsePass(positions, quadrics, locked, tris, targetIndexCount, remap, maxError);
+            if (collapses == 0)
+                break;
+
+            // Aplicar colapsos e remover triângulos degenerados
+            size_t write = 0;
+            for (size_t i = 0; i < tris.size(); i += 3)
+            {
+                unsigned int a = remap[tris[i]], b = remap[tris[i + 1]], c = remap[tris[i + 2]];
+                if (a != b && b != c && a != c)
+                {
+                    tris[write++] = a;
+                    tris[write++] = b;
+                    tris[write++] = c;
+                }
+            }
+            tris.resize(write);
+        }
+
+        error = static_cast<float>(std::sqrt(maxError));
+        return pickWedges(vertices, node, positions, tris);
+    }
+
+private:
+    // Quádrica simétrica 4x4 (10 coeficientes) e peso acumulado (área)
+    struct Quadric
+    {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0, c = 0;
+        double w = 0;
+
+        static Quadric fromTriangle(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2)
+        {
+            Quadric q;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            double len = glm::length(n);
+            if (len <= 0.0)
+                return q;
+
+            double area = len * 0.5;
+            double nx = n.x / len, ny = n.y / len, nz = n.z / len;
+            double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+
+            q.a00 = nx * nx * area;
+            q.a01 = nx * ny * area;
+            q.a02 = nx * nz * area;
+            q.a11 = ny * ny * area;
+            q.a12 = ny * nz * area;
+            q.a22 = nz * nz * area;
+            q.b0 = nx * d * area;
+            q.b1 = ny * d * area;
+            q.b2 = nz * d * area;
+            q.c = d * d * area;
+            q.w = area;
+            return q;
+        }
+
+        void add(const Quadric &o)
+        {
+            a00 += o.a00, a01 += o.a01, a02 += o.a02, a11 += o.a11, a12 += o.a12, a22 += o.a22;
+            b0 += o.b0, b1 += o.b1, b2 += o.b2, c += o.c;
+            w += o.w;
+        }
+
+        // Distância quadrática média (ponderada pela área) aos planos
+        double error(const glm::vec3 &p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return w > 0.0 ? std::max(e, 0.0) / w : 0.0;
+        }
+    };
+
+    struct Collapse
+    {
+        unsigned int from, to;
+        double cost;
+    };
+
+    static uint64_t edgeKey(unsigned int a, unsigned int b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    // Arestas com um só triângulo (fronteira) ou mais de dois (não-manifold)
+    static void lockBorders(const std::vector<unsigned int> &tris, std::vector<char> &locked)
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(tris.size());
+        for (size_t i = 0; i < tris.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+                edges.push_back(edgeKey(tris[i + k], tris[i + (k + 1) % 3]));
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i])
+                ++j;
+            if (j - i != 2)
+            {
+                locked[edges[i] >> 32] = 1;
+                locked[edges[i] & 0xFFFFFFFFu] = 1;
+            }
+            i = j;
+        }
+    }
+
+    static size_t collapsePass(const std::vector<glm::vec3> &positions, std::vector<Quadric> &quadrics,
+                               const std::vector<char> &locked, const std::vector<unsigned int> &tris,
+                               size_t targetIndexCount, std::vector<unsigned int> &remap, double &maxError)
+    {
+        size_t nodeCount = positions.size();
+
+        // Adjacência nó -> triângulos (CSR)
+        std::vector<unsigned int> offsets(nodeCount + 1, 0);
+        for (unsigned int v : tris)
+            offsets[v + 1]++;
+        for (size_t n = 0; n < nodeCount; ++n)
+            offsets[n + 1] += offsets[n];
+        std::vector<unsigned int> adjacency(tris.size());
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < tris.size(); ++i)
+                adjacency[fill[tris[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        // Arestas únicas e o melhor sentido de colapso de cada uma
+        std::vector<uint64_t> edges;
+        edges.reserve(tris.size());
+        for (size_t i = 0; i < tris.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+                edges.push_back(edgeKey(tris[i + k], tris[i + (k + 1) % 3]));
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        std::vector<Collapse> collapses;
+        collapses.reserve(edges.size());
+        for (uint64_t e : edges)
+        {
+            unsigned int a = static_cast<unsigned int>(e >> 32), b = static_cast<unsigned int>(e & 0xFFFFFFFFu);
+            Quadric q = quadrics[a];
+            q.add(quadrics[b]);
+
+            if (!locked[a])
+                collapses.push_back({a, b, q.error(positions[b])});
+            if (!locked[b] && (locked[a] || q.error(positions[a]) < collapses.back().cost))
+            {
+                if (!locked[a])
+                    collapses.pop_back();
+                collapses.push_back({b, a, q.error(positions[a])});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse &x, const Collapse &y)
+                  { return x.cost < y.cost; });
+
+        // Cada colapso interior remove dois triângulos
+        size_t triangleCount = tris.size() / 3;
+        size_t targetTriangles = targetIndexCount / 3;
+        size_t wanted = triangleCount > targetTriangles ? (triangleCount - targetTriangles + 1) / 2 : 0;
+
+        // Só um colapso por vizinhança em cada passagem, para que a verificação
+        // de inversão de normais continue válida
+        std::vector<char> dirty(nodeCount, 0);
+        size_t done = 0;
+        for (const Collapse &c : collapses)
+        {
+            if (done >= wanted)
+                break;
+            if (dirty[c.from] || dirty[c.to] || flips(positions, tris, adjacency, offsets, c.from, c.to))
+                continue;
+
+            remap[c.from] = c.to;
+            quadrics[c.to].add(quadrics[c.from]);
+            maxError = std::max(maxError, c.cost);
+
+            for (unsigned int i = offsets[c.from]; i < offsets[c.from + 1]; ++i)
+            {
+                const unsigned int *tri = &tris[adjacency[i] * 3];
+                dirty[tri[0]] = dirty[tri[1]] = dirty[tri[2]] = 1;
+            }
+            done++;
+        }
+        return done;
+    }
+
+    // true se mover "from" para "to" inverte ou degenera algum triângulo que
+    // sobrevive ao colapso
+    static bool flips(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &tris,
+                      const std::vector<unsigned int> &adjacency, const std::vector<unsigned int> &offsets,
+                      unsigned int from, unsigned int to)
+    {
+        for (unsigned int i = offsets[from]; i < offsets[from + 1]; ++i)
+        {
+            const unsigned int *tri = &tris[adjacency[i] * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue; // triângulo que desaparece
+
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                p[k] = positions[tri[k]];
+                q[k] = positions[tri[k] == from ? to : tri[k]];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            if (glm::dot(before, after) <= 0.0f)
+                return true;
+        }
+        return false;
+    }
+
+    // Para cada canto escolhe, entre os vértices com aquela posição, o que tem
+    // a normal mais próxima da normal da face simplificada
+    static std::vector<unsigned int> pickWedges(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &node,
+                                                const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &tris)
+    {
+        std::vector<unsigned int> offsets(positions.size() + 1, 0);
+        for (unsigned int n : node)
+            offsets[n + 1]++;
+        for (size_t n = 0; n < positions.size(); ++n)
+            offsets[n + 1] += offsets[n];
+        std::vector<unsigned int> wedges(vertices.size());
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t v = 0; v < vertices.size(); ++v)
+                wedges[fill[node[v]]++] = static_cast<unsigned int>(v);
+        }
+
+        std::vector<unsigned int> result(tris.size());
+        for (size_t i = 0; i < tris.size(); i += 3)
+        {
+            glm::vec3 faceNormal = glm::cross(positions[tris[i + 1]] - positions[tris[i]],
+                                              positions[tris[i + 2]] - positions[tris[i]]);
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int n = tris[i + k];
+                unsigned int best = wedges[offsets[n]];
+                float bestDot = -2.0f;
+                for (unsigned int w = offsets[n]; w < offsets[n + 1] && offsets[n + 1] - offsets[n] > 1; ++w)
+                {
+                    float d = glm::dot(vertices[wedges[w]].Normal, faceNormal);
+                    if (d > bestDot)
+                    {
+                        bestDot = d;
+                        best = wedges[w];
+                    }
+                }
+                result[i + k] = best;
+            }
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef MESH_TOPOLOGY_H
+#define MESH_TOPOLOGY_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_types.h"
+
+// Resultado de MeshTopology::repairWinding para um SubMesh
+struct WindingReport
+{
+    size_t components = 0;       // componentes ligadas por arestas manifold
+    size_t closedComponents = 0; // sem arestas de fronteira nem non-manifold
+    size_t flippedTriangles = 0;
+    size_t conflicts = 0; // arestas onde a orientação não é consistente (superfície não orientável)
+    bool closed = false;  // todas as componentes fechadas e orientáveis: pode usar back-face culling
+};
+
+// Orientação consistente dos triângulos. A adjacência é construída sobre
+// posições (como no simplificador), a orientação propaga-se por BFS através
+// das arestas manifold e cada componente é virada para fora pelo sinal do
+// volume. Componentes abertas, non-manifold ou sem volume (folhas, velas,
+// planos de dupla face) ficam marcadas para serem desenhadas sem culling.
+class MeshTopology
+{
+public:
+    static WindingReport repairWinding(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices)
+    {
+        WindingReport report;
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return report;
+
+        std::vector<unsigned int> node(vertices.size());
+        {
+            std::unordered_map<PositionKey, unsigned int, PositionHash> lookup;
+            lookup.reserve(vertices.size());
+            for (size_t v = 0; v < vertices.size(); ++v)
+                node[v] = lookup.emplace(PositionKey(vertices[v].Position), (unsigned int)lookup.size()).first->second;
+        }
+
+        // Semi-arestas ordenadas pela aresta não orientada
+        std::vector<HalfEdge> halfEdges;
+        halfEdges.reserve(indices.size());
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int a = node[indices[t * 3 + k]];
+                unsigned int b = node[indices[t * 3 + (k + 1) % 3]];
+                if (a != b)
+                    halfEdges.push_back({edgeKey(a, b), (unsigned int)t, a < b});
+            }
+        }
+        std::sort(halfEdges.begin(), halfEdges.end(),
+                  [](const HalfEdge &x, const HalfEdge &y)
+                  { return x.key < y.key; });
+
+        // Vizinhos por arestas manifold (exatamente dois triângulos), em CSR.
+        // sameDirection = os dois percorrem a aresta no mesmo sentido, ou seja,
+        // um deles tem de ser virado.
+        std::vector<unsigned int> neighborStart(triangleCount + 1, 0);
+        std::vector<char> open(triangleCount, 0);
+        forEachEdge(halfEdges, [&](size_t first, size_t count)
+                    {
+            if (count == 2)
+            {
+                neighborStart[halfEdges[first].triangle + 1]++;
+                neighborStart[halfEdges[first + 1].triangle + 1]++;
+            }
+            else
+            {
+                for (size_t i = first; i < first + count; ++i)
+                    open[halfEdges[i].triangle] = 1;
+            } });
+        for (size_t t = 0; t < triangleCount; ++t)
+            neighborStart[t + 1] += neighborStart[t];
+
+        std::vector<Neighbor> neighbors(neighborStart[triangleCount]);
+        std::vector<unsigned int> cursor(neighborStart.begin(), neighborStart.end() - 1);
+        forEachEdge(halfEdges, [&](size_t first, size_t count)
+                    {
+            if (count != 2)
+                return;
+            const HalfEdge &x = halfEdges[first];
+            const HalfEdge &y = halfEdges[first + 1];
+            bool same = x.forward == y.forward;
+            neighbors[cursor[x.triangle]++] = {y.triangle, same};
+            neighbors[cursor[y.triangle]++] = {x.triangle, same}; });
+
+        // BFS por componente: flip[t] = o triângulo tem de ser virado
+        std::vector<int> component(triangleCount, -1);
+        std::vector<char> flip(triangleCount, 0);
+        std::vector<unsigned int> queue;
+        std::vector<char> componentOpen;
+        for (size_t seed = 0; seed < triangleCount; ++seed)
+        {
+            if (component[seed] >= 0)
+                continue;
+
+            int id = (int)report.components++;
+            componentOpen.push_back(0);
+            component[seed] = id;
+            queue.assign(1, (unsigned int)seed);
+            for (size_t q = 0; q < queue.size(); ++q)
+            {
+                unsigned int t = queue[q];
+                componentOpen[id] |= open[t];
+                for (unsigned int i = neighborStart[t]; i < neighborStart[t + 1]; ++i)
+                {
+                    const Neighbor &n = neighbors[i];
+                    char expected = flip[t] ^ (n.sameDirection ? 1 : 0);
+                    if (component[n.triangle] < 0)
+                    {
+                        component[n.triangle] = id;
+                        flip[n.triangle] = expected;
+                        queue.push_back(n.triangle);
+                    }
+                    else if (flip[n.triangle] != expected && n.triangle > t)
+                    {
+                        report.conflicts++;
+                        componentOpen[id] = 1;
+                    }
+                }
+            }
+        }
+
+        // Sinal do volume de cada componente já orientada (em relação a um
+        // ponto da própria componente, para reduzir cancelamento)
+        std::vector<glm::dvec3> origin(report.components);
+        std::vector<char> hasOrigin(report.components, 0);
+        std::vector<double> volume(report.components, 0.0);
+        glm::vec3 minP(vertices.empty() ? glm::vec3(0.0f) : vertices[0].Position), maxP(minP);
+        for (const Vertex &v : vertices)
+        {
+            minP = glm::min(minP, v.Position);
+            maxP = glm::max(maxP, v.Position);
+        }
+
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            int id = component[t];
+            glm::dvec3 p0(vertices[indices[t * 3]].Position);
+            glm::dvec3 p1(vertices[indices[t * 3 + 1]].Position);
+            glm::dvec3 p2(vertices[indices[t * 3 + 2]].Position);
+            if (flip[t])
+                std::swap(p1, p2);
+            if (!hasOrigin[id])
+            {
+                origin[id] = p0;
+                hasOrigin[id] = 1;
+            }
+            p0 -= origin[id];
+            p1 -= origin[id];
+            p2 -= origin[id];
+            volume[id] += glm::dot(p0, glm::cross(p1, p2)) / 6.0;
+        }
+
+        double extent = glm::length(glm::dvec3(maxP - minP));
+        double minVolume = 1e-6 * extent * extent * extent;
+        report.closed = true;
+        for (size_t c = 0; c < report.components; ++c)
+        {
+            bool closed = !componentOpen[c] && std::abs(volume[c]) > minVolume;
+            report.closedComponents += closed ? 1 : 0;
+            report.closed = report.closed && closed;
+        }
+
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            if (volume[component[t]] < 0.0)
+                flip[t] ^= 1;
+            if (flip[t])
+            {
+                std::swap(indices[t * 3 + 1], indices[t * 3 + 2]);
+                report.flippedTriangles++;
+            }
+        }
+
+        alignNormals(vertices, indices);
+        return report;
+    }
+
+private:
+    struct HalfEdge
+    {
+        uint64_t key;
+        unsigned int triangle;
+        bool forward; // a < b no sentido do triângulo
+    };
+
+    struct Neighbor
+    {
+        unsigned int triangle;
+        bool sameDirection;
+    };
+
+    static uint64_t edgeKey(unsigned int a, unsigned int b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    template <typename Fn>
+    static void forEachEdge(const std::vector<HalfEdge> &halfEdges, Fn fn)
+    {
+        for (size_t i = 0; i < halfEdges.size();)
+        {
+            size_t j = i + 1;
+            while (j < halfEdges.size() && halfEdges[j].key == halfEdges[i].key)
+                ++j;
+            fn(i, j - i);
+            i = j;
+        }
+    }
+
+    // Normais de vértice que apontam contra os triângulos que as usam (depois
+    // de virados) são invertidas, para a iluminação seguir a nova orientação
+    static void alignNormals(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+    {
+        std::vector<glm::vec3> faceSum(vertices.size(), glm::vec3(0.0f));
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const glm::vec3 &p0 = vertices[indices[i]].Position;
+            glm::vec3 n = glm::cross(vertices[indices[i + 1]].Position - p0, vertices[indices[i + 2]].Position - p0);
+            for (int k = 0; k < 3; ++k)
+                faceSum[indices[i + k]] += n;
+        }
+        for (size_t v = 0; v < vertices.size(); ++v)
+            if (glm::dot(vertices[v].Normal, faceSum[v]) < 0.0f)
+                vertices[v].Normal = -vertices[v].Normal;
+    }
+};
+
+#endif
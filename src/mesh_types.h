@@ -0,0 +1,189 @@
+#ifndef MESH_TYPES_H
+#define MESH_TYPES_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+struct Vertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+};
+
+struct Material
+{
+    std::string name;
+    glm::vec3 ambient;  // Ka
+    glm::vec3 diffuse;  // Kd
+    glm::vec3 specular; // Ks
+    float shininess;    // Ns
+};
+
+// Volume envolvente: AABB e esfera (centrada na AABB)
+struct Bounds
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    static Bounds fromBox(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        Bounds b;
+        b.min = min;
+        b.max = max;
+        b.center = (min + max) * 0.5f;
+        b.radius = glm::length(max - b.center);
+        return b;
+    }
+
+    static Bounds fromSphere(const glm::vec3 &center, float radius)
+    {
+        return fromBox(center - glm::vec3(radius), center + glm::vec3(radius));
+    }
+
+    // AABB dos pontos; o raio é o da esfera centrada na AABB que os contém
+    static Bounds fromVertices(const std::vector<Vertex> &vertices)
+    {
+        if (vertices.empty())
+            return Bounds();
+
+        glm::vec3 minP(std::numeric_limits<float>::max()), maxP(-std::numeric_limits<float>::max());
+        for (const Vertex &v : vertices)
+        {
+            minP = glm::min(minP, v.Position);
+            maxP = glm::max(maxP, v.Position);
+        }
+
+        Bounds b = fromBox(minP, maxP);
+        float radius2 = 0.0f;
+        for (const Vertex &v : vertices)
+        {
+            glm::vec3 d = v.Position - b.center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+        b.radius = std::sqrt(radius2);
+        return b;
+    }
+};
+
+// Posição comparada bit a bit (chave de hash para agrupar vértices com a
+// mesma posição e normais diferentes)
+struct PositionKey
+{
+    uint32_t x, y, z;
+
+    explicit PositionKey(const glm::vec3 &p)
+    {
+        std::memcpy(&x, &p.x, 4);
+        std::memcpy(&y, &p.y, 4);
+        std::memcpy(&z, &p.z, 4);
+    }
+
+    bool operator==(const PositionKey &o) const
+    {
+        return x == o.x && y == o.y && z == o.z;
+    }
+};
+
+struct PositionHash
+{
+    size_t operator()(const PositionKey &k) const
+    {
+        uint64_t h = k.x * 0x9E3779B97F4A7C15ull;
+        h = (h ^ (h >> 29) ^ k.y) * 0xC2B2AE3D27D4EB4Full;
+        h = (h ^ (h >> 32) ^ k.z) * 0x165667B19E3779F9ull;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+};
+
+// Nível de detalhe: intervalo no EBO e erro geométrico (unidades do modelo)
+struct MeshLod
+{
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    float error;
+    unsigned int vertexCount; // prefixo do VBO do SubMesh usado por este nível e pelos mais simples
+};
+
+// Grupo de triângulos contíguo no LOD 0 (ver MeshletBuilder), com os
+// volumes usados para o rejeitar por frustum e por orientação
+struct Meshlet
+{
+    unsigned int firstIndex; // relativo ao início do SubMesh no EBO
+    unsigned int indexCount;
+    glm::vec3 center; // esfera envolvente (espaço do modelo)
+    float radius;
+    glm::vec3 coneAxis; // média das normais das faces
+    float coneCutoff;   // seno do ângulo do cone; 1 = sem teste de cone
+};
+
+struct SubMesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;    // LOD 0 (resolução total)
+    std::vector<unsigned int> lodIndices; // LODs 1..n concatenados a seguir a indices no EBO
+    std::vector<MeshLod> lods;            // lods[0] cobre indices
+    std::vector<Meshlet> meshlets;        // partição de indices
+    unsigned int currentLod = 0;
+    bool cullBackFaces = false; // superfícies fechadas e orientadas para fora
+    Bounds bounds;              // espaço do modelo
+    bool visible = true;        // resultado do último Mesh::cullFrustum
+    // Vértices quantizados no VBO: posição = positionOffset + aPos * positionScale
+    bool quantized = false;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    Material material;
+    unsigned int materialIndex = 0; // no bloco de materiais do Mesh
+    // Posição no VBO/EBO partilhados do Mesh
+    unsigned int baseVertex = 0;
+    unsigned int firstIndex = 0;
+};
+
+// Comando de glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance; // = índice do draw (ver aDrawId no vertex.glsl)
+};
+
+// Dados por draw no SSBO (std430), indexados pelo índice do draw
+struct DrawData
+{
+    glm::vec4 positionOffset; // w = 1 se os vértices estão quantizados
+    glm::vec4 positionScale;
+    unsigned int materialIndex;
+    unsigned int padding[3];
+};
+
+// Material no bloco uniforme MaterialBlock (std140): cada vec3 ocupa 16
+// bytes, exceto o último, onde shininess aproveita a quarta componente
+struct GpuMaterial
+{
+    glm::vec3 ambient;
+    float padding0;
+    glm::vec3 diffuse;
+    float padding1;
+    glm::vec3 specular;
+    float shininess;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "comando indireto deve ter 20 bytes");
+static_assert(sizeof(DrawData) == 48, "DrawData deve seguir o layout std430 do shader");
+static_assert(offsetof(DrawData, materialIndex) == 32, "DrawData::materialIndex fora do sítio");
+static_assert(sizeof(GpuMaterial) == 48, "stride std140 de Material é 48 bytes");
+static_assert(offsetof(GpuMaterial, ambient) == 0 && offsetof(GpuMaterial, diffuse) == 16 &&
+                  offsetof(GpuMaterial, specular) == 32 && offsetof(GpuMaterial, shininess) == 44,
+              "GpuMaterial não segue o layout std140");
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "frustum.h"
+#include "mesh_types.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MESHLET_SSE 1
+#endif
+
+// Divide o LOD 0 de um SubMesh em meshlets: intervalos contíguos do índice
+// com até MAX_VERTICES vértices distintos e MAX_TRIANGLES triângulos, cada
+// um com esfera envolvente e cone de normais. Os triângulos são percorridos
+// pela ordem do EBO (já otimizada para a cache de vértices, por isso
+// localmente coerente) e não são reordenados.
+class MeshletBuilder
+{
+public:
+    static constexpr size_t MAX_VERTICES = 64;
+    static constexpr size_t MAX_TRIANGLES = 124;
+
+    static std::vector<Meshlet> build(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+    {
+        std::vector<Meshlet> meshlets;
+        // meshlet em que cada vértice foi visto pela última vez
+        std::vector<unsigned int> seenIn(vertices.size(), std::numeric_limits<unsigned int>::max());
+        unsigned int current = 0;
+        size_t vertexCount = 0, first = 0;
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            size_t added = 0;
+            for (int k = 0; k < 3; ++k)
+                added += seenIn[indices[i + k]] != current ? 1 : 0;
+
+            size_t triangles = (i - first) / 3;
+            if (triangles > 0 && (vertexCount + added > MAX_VERTICES || triangles + 1 > MAX_TRIANGLES))
+            {
+                meshlets.push_back(makeMeshlet(vertices, indices, first, i));
+                first = i;
+                vertexCount = 0;
+                ++current;
+            }
+
+            for (int k = 0; k < 3; ++k)
+            {
+                if (seenIn[indices[i + k]] != current)
+                {
+                    seenIn[indices[i + k]] = current;
+                    ++vertexCount;
+                }
+            }
+        }
+        if (first + 2 < indices.size())
+            meshlets.push_back(makeMeshlet(vertices, indices, first, indices.size() / 3 * 3));
+        return meshlets;
+    }
+
+private:
+    // Abaixo disto (cone com mais de ~84 graus) o teste quase nunca rejeita
+    static constexpr float MIN_CONE_DOT = 0.1f;
+
+    static Meshlet makeMeshlet(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+                               size_t first, size_t end)
+    {
+        Meshlet m;
+        m.firstIndex = (unsigned int)first;
+        m.indexCount = (unsigned int)(end - first);
+
+        glm::vec3 minP(std::numeric_limits<float>::max()), maxP(-std::numeric_limits<float>::max());
+        for (size_t i = first; i < end; ++i)
+        {
+            minP = glm::min(minP, vertices[indices[i]].Position);
+            maxP = glm::max(maxP, vertices[indices[i]].Position);
+        }
+        m.center = (minP + maxP) * 0.5f;
+        float radius2 = 0.0f;
+        for (size_t i = first; i < end; ++i)
+        {
+            glm::vec3 d = vertices[indices[i]].Position - m.center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+        m.radius = std::sqrt(radius2);
+
+        // Eixo = média das normais unitárias das faces; o ângulo do cone é o
+        // da normal mais afastada do eixo. Faces degeneradas não contam.
+        std::vector<glm::vec3> normals;
+        normals.reserve((end - first) / 3);
+        glm::vec3 axis(0.0f);
+        for (size_t i = first; i < end; i += 3)
+        {
+            const glm::vec3 &a = vertices[indices[i]].Position;
+            glm::vec3 n = glm::cross(vertices[indices[i + 1]].Position - a, vertices[indices[i + 2]].Position - a);
+            float length = glm::length(n);
+            if (length > 0.0f)
+            {
+                normals.push_back(n / length);
+                axis += normals.back();
+            }
+        }
+
+        m.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        m.coneCutoff = 1.0f; // nunca rejeita
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength <= 0.0f)
+            return m;
+
+        axis /= axisLength;
+        float minDot = 1.0f;
+        for (const glm::vec3 &n : normals)
+            minDot = std::min(minDot, glm::dot(n, axis));
+        if (minDot <= MIN_CONE_DOT)
+            return m;
+
+        // Todas as faces estão de costas quando a direção de vista faz menos
+        // de 90 - ângulo graus com o eixo, ou seja dot >= sin(ângulo)
+        m.coneAxis = axis;
+        m.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        return m;
+    }
+};
+
+// Meshlets de todos os SubMeshes em SoA, para testar quatro de cada vez:
+// esfera contra o frustum e cone de normais contra a posição da câmara
+// (ambos no espaço do modelo)
+class MeshletCuller
+{
+public:
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+        axisX.clear();
+        axisY.clear();
+        axisZ.clear();
+        cutoff.clear();
+        visible.clear();
+    }
+
+    // backFaces: o SubMesh é desenhado com back-face culling, por isso os
+    // meshlets virados para trás podem ser rejeitados
+    void add(const Meshlet &m, bool backFaces)
+    {
+        x.push_back(m.center.x);
+        y.push_back(m.center.y);
+        z.push_back(m.center.z);
+        radius.push_back(m.radius);
+        axisX.push_back(m.coneAxis.x);
+        axisY.push_back(m.coneAxis.y);
+        axisZ.push_back(m.coneAxis.z);
+        cutoff.push_back(backFaces ? m.coneCutoff : 1.0f);
+        visible.push_back(1); // até ao primeiro cull()
+    }
+
+    size_t size() const { return x.size(); }
+
+    // visible[i] fica a 1 se o meshlet i pode ter triângulos visíveis.
+    // Devolve quantos passam.
+    size_t cull(const Frustum &frustum, const glm::vec3 &cameraPos)
+    {
+        size_t count = x.size();
+        visible.resize(count);
+        frustum.testSpheres(x.data(), y.data(), z.data(), radius.data(), count, visible.data());
+
+        size_t i = 0;
+#ifdef MESHLET_SSE
+        const __m128 cx = _mm_set1_ps(cameraPos.x), cy = _mm_set1_ps(cameraPos.y), cz = _mm_set1_ps(cameraPos.z);
+        for (; i + 4 <= count; i += 4)
+        {
+            // dot(centro - câmara, eixo) >= cutoff * |centro - câmara| + raio
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(x.data() + i), cx);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(y.data() + i), cy);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(z.data() + i), cz);
+            __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+            __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(axisX.data() + i)),
+                                                 _mm_mul_ps(dy, _mm_loadu_ps(axisY.data() + i))),
+                                      _mm_mul_ps(dz, _mm_loadu_ps(axisZ.data() + i)));
+            __m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(cutoff.data() + i), dist), _mm_loadu_ps(radius.data() + i));
+            int backFacing = _mm_movemask_ps(_mm_cmpge_ps(along, limit));
+            for (int k = 0; k < 4; ++k)
+                if ((backFacing >> k) & 1)
+                    visible[i + k] = 0;
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            glm::vec3 d = glm::vec3(x[i], y[i], z[i]) - cameraPos;
+            if (glm::dot(d, glm::vec3(axisX[i], axisY[i], axisZ[i])) >= cutoff[i] * glm::length(d) + radius[i])
+                visible[i] = 0;
+        }
+
+        size_t passed = 0;
+        for (unsigned char v : visible)
+            passed += v;
+        return passed;
+    }
+
+    const unsigned char *visibility() const { return visible.data(); }
+
+private:
+    std::vector<float> x, y, z, radius;
+    std::vector<float> axisX, axisY, axisZ, cutoff;
+    std::vector<unsigned char> visible;
+};
+
+#endif
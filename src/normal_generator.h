@@ -0,0 +1,242 @@
+#ifndef NORMAL_GENERATOR_H
+#define NORMAL_GENERATOR_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NORMAL_GENERATOR_SSE 1
+#endif
+
+// Normais suaves por posição (média das normais das faces pesada pela área)
+// para OBJs sem "vn". Duas passagens paralelas sem escritas partilhadas:
+// normais das faces (quatro triângulos de cada vez com SSE) e, por intervalo
+// de vértices, soma das faces adjacentes (lidas da adjacência vértice ->
+// faces em CSR) seguida de normalização. Triângulos degenerados não
+// contribuem.
+class NormalGenerator
+{
+public:
+    // Abaixo disto não compensa lançar threads
+    static constexpr size_t PARALLEL_MIN_TRIANGLES = 64 * 1024;
+
+    // faces: listas de índices 1-based, três por triângulo (ObjFaceGroup).
+    // normals fica com uma normal por posição; posições sem faces (ou só com
+    // faces degeneradas) recebem (0, 1, 0). Devolve o número de threads usadas.
+    static unsigned int computeSmooth(const std::vector<glm::vec3> &positions,
+                                      const std::vector<const std::vector<unsigned int> *> &faces,
+                                      std::vector<glm::vec3> &normals, unsigned int threadCount = 0)
+    {
+        size_t vertexCount = positions.size();
+        size_t triangleCount = 0;
+        for (const std::vector<unsigned int> *list : faces)
+            triangleCount += list->size() / 3;
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if (triangleCount < PARALLEL_MIN_TRIANGLES)
+            threadCount = 1;
+
+        normals.assign(vertexCount, glm::vec3(0.0f));
+
+        // Um thread: normais das faces em blocos que cabem na cache, somadas
+        // logo a seguir
+        if (threadCount == 1)
+        {
+            float fx[BLOCK_TRIANGLES], fy[BLOCK_TRIANGLES], fz[BLOCK_TRIANGLES];
+            for (const std::vector<unsigned int> *list : faces)
+            {
+                size_t count = list->size() / 3;
+                for (size_t begin = 0; begin < count; begin += BLOCK_TRIANGLES)
+                {
+                    size_t end = std::min(count, begin + BLOCK_TRIANGLES);
+                    const unsigned int *tri = list->data() + begin * 3;
+                    faceNormals(tri, positions.data(), fx, fy, fz, 0, end - begin);
+                    accumulate(tri, end - begin, fx, fy, fz, normals.data(), 0, vertexCount);
+                }
+            }
+            normalize(normals.data(), 0, vertexCount);
+            return 1;
+        }
+
+        // Normal de cada face pesada pela área: cross(e1, e2) / 2. As listas
+        // são lidas no sítio; a face i da lista l fica em first[l] + i.
+        std::vector<float> fx(triangleCount), fy(triangleCount), fz(triangleCount);
+        size_t first = 0;
+        for (const std::vector<unsigned int> *list : faces)
+        {
+            size_t count = list->size() / 3;
+            parallelFor(count, threadCount, [&](size_t begin, size_t end)
+                        { faceNormals(list->data(), positions.data(), fx.data() + first,
+                                      fy.data() + first, fz.data() + first, begin, end); });
+            first += count;
+        }
+
+        // Adjacência vértice -> faces em CSR, uma entrada por canto: conta,
+        // soma inclusiva (offsets[v] = fim da lista de v) e preenche de trás
+        // para a frente, deixando offsets[v] no início da lista de v e as
+        // faces de cada lista por ordem crescente.
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (const std::vector<unsigned int> *list : faces)
+        {
+            const unsigned int *corner = list->data(), *cornerEnd = corner + list->size() / 3 * 3;
+            for (; corner < cornerEnd; ++corner)
+                if (*corner - 1 < vertexCount)
+                    offsets[*corner - 1]++;
+        }
+        for (size_t v = 1; v <= vertexCount; ++v)
+            offsets[v] += offsets[v - 1];
+
+        std::vector<unsigned int> adjacency(offsets[vertexCount]);
+        size_t face = triangleCount;
+        for (size_t l = faces.size(); l-- > 0;)
+        {
+            const unsigned int *tri = faces[l]->data();
+            face -= faces[l]->size() / 3;
+            for (size_t c = faces[l]->size() / 3 * 3; c-- > 0;)
+                if (tri[c] - 1 < vertexCount)
+                    adjacency[--offsets[tri[c] - 1]] = (unsigned int)(face + c / 3);
+        }
+
+        // Cada thread é dono de um intervalo de vértices e só lê as faces
+        // adjacentes, sem escritas partilhadas. A soma segue a ordem das
+        // faces, por isso o resultado é o mesmo qualquer que seja o número
+        // de threads (e igual ao do caminho de um thread).
+        parallelFor(vertexCount, threadCount, [&](size_t begin, size_t end)
+                    {
+            for (size_t v = begin; v < end; ++v)
+            {
+                glm::vec3 sum(0.0f);
+                for (unsigned int a = offsets[v]; a < offsets[v + 1]; ++a)
+                {
+                    unsigned int f = adjacency[a];
+                    sum += glm::vec3(fx[f], fy[f], fz[f]);
+                }
+                normals[v] = sum;
+            }
+            normalize(normals.data(), begin, end); });
+        return threadCount;
+    }
+
+private:
+    // Comprimento mínimo da soma para normalizar (igual ao caminho antigo)
+    static constexpr float MIN_LENGTH = 0.001f;
+    static constexpr size_t BLOCK_TRIANGLES = 1024;
+
+    // Divide [0, count) em threadCount blocos contíguos; o último corre no
+    // thread atual
+    template <typename Fn>
+    static void parallelFor(size_t count, unsigned int threadCount, Fn fn)
+    {
+        if (threadCount <= 1 || count < threadCount)
+        {
+            fn(0, count);
+            return;
+        }
+
+        size_t perThread = (count + threadCount - 1) / threadCount;
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t + 1 < threadCount; ++t)
+        {
+            size_t begin = t * perThread, end = std::min(count, begin + perThread);
+            if (begin < end)
+                threads.emplace_back(fn, begin, end);
+        }
+        fn(std::min(count, (threadCount - 1) * perThread), count);
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    // tri: índices 1-based
+    static void faceNormals(const unsigned int *tri, const glm::vec3 *p,
+                            float *fx, float *fy, float *fz, size_t begin, size_t end)
+    {
+        size_t t = begin;
+#ifdef NORMAL_GENERATOR_SSE
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; t + 4 <= end; t += 4)
+        {
+            const unsigned int *i = tri + t * 3;
+            const glm::vec3 &a0 = p[i[0] - 1], &a1 = p[i[3] - 1], &a2 = p[i[6] - 1], &a3 = p[i[9] - 1];
+            const glm::vec3 &b0 = p[i[1] - 1], &b1 = p[i[4] - 1], &b2 = p[i[7] - 1], &b3 = p[i[10] - 1];
+            const glm::vec3 &c0 = p[i[2] - 1], &c1 = p[i[5] - 1], &c2 = p[i[8] - 1], &c3 = p[i[11] - 1];
+            __m128 ax = _mm_setr_ps(a0.x, a1.x, a2.x, a3.x);
+            __m128 ay = _mm_setr_ps(a0.y, a1.y, a2.y, a3.y);
+            __m128 az = _mm_setr_ps(a0.z, a1.z, a2.z, a3.z);
+            __m128 e1x = _mm_sub_ps(_mm_setr_ps(b0.x, b1.x, b2.x, b3.x), ax);
+            __m128 e1y = _mm_sub_ps(_mm_setr_ps(b0.y, b1.y, b2.y, b3.y), ay);
+            __m128 e1z = _mm_sub_ps(_mm_setr_ps(b0.z, b1.z, b2.z, b3.z), az);
+            __m128 e2x = _mm_sub_ps(_mm_setr_ps(c0.x, c1.x, c2.x, c3.x), ax);
+            __m128 e2y = _mm_sub_ps(_mm_setr_ps(c0.y, c1.y, c2.y, c3.y), ay);
+            __m128 e2z = _mm_sub_ps(_mm_setr_ps(c0.z, c1.z, c2.z, c3.z), az);
+
+            _mm_storeu_ps(fx + t, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y)), half));
+            _mm_storeu_ps(fy + t, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z)), half));
+            _mm_storeu_ps(fz + t, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x)), half));
+        }
+#endif
+        for (; t < end; ++t)
+        {
+            const unsigned int *i = tri + t * 3;
+            const glm::vec3 &a = p[i[0] - 1];
+            glm::vec3 n = glm::cross(p[i[1] - 1] - a, p[i[2] - 1] - a) * 0.5f;
+            fx[t] = n.x;
+            fy[t] = n.y;
+            fz[t] = n.z;
+        }
+    }
+
+    static void accumulate(const unsigned int *tri, size_t triangleCount,
+                           const float *fx, const float *fy, const float *fz,
+                           glm::vec3 *normals, size_t begin, size_t end)
+    {
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                size_t v = tri[t * 3 + k] - 1;
+                if (v >= begin && v < end)
+                    normals[v] += glm::vec3(fx[t], fy[t], fz[t]);
+            }
+        }
+    }
+
+    // valid ? soma / comprimento : (0, 1, 0)
+    static void normalize(glm::vec3 *normals, size_t begin, size_t end)
+    {
+        size_t v = begin;
+#ifdef NORMAL_GENERATOR_SSE
+        const __m128 minLength = _mm_set1_ps(MIN_LENGTH);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; v + 4 <= end; v += 4)
+        {
+            glm::vec3 *n = normals + v;
+            __m128 x = _mm_setr_ps(n[0].x, n[1].x, n[2].x, n[3].x);
+            __m128 y = _mm_setr_ps(n[0].y, n[1].y, n[2].y, n[3].y);
+            __m128 z = _mm_setr_ps(n[0].z, n[1].z, n[2].z, n[3].z);
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+            __m128 valid = _mm_cmpgt_ps(length, minLength);
+            __m128 inverse = _mm_div_ps(one, length);
+
+            float sx[4], sy[4], sz[4];
+            _mm_storeu_ps(sx, _mm_and_ps(valid, _mm_mul_ps(x, inverse)));
+            _mm_storeu_ps(sy, _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(y, inverse)), _mm_andnot_ps(valid, one)));
+            _mm_storeu_ps(sz, _mm_and_ps(valid, _mm_mul_ps(z, inverse)));
+            for (int k = 0; k < 4; ++k)
+                n[k] = glm::vec3(sx[k], sy[k], sz[k]);
+        }
+#endif
+        for (; v < end; ++v)
+        {
+            // recíproco, como no caminho SSE, para dar o mesmo resultado
+            float length = glm::length(normals[v]);
+            normals[v] = length > MIN_LENGTH ? normals[v] * (1.0f / length) : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,479 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sequência de faces com o mesmo material (um bloco entre dois "usemtl")
+struct ObjFaceGroup
+{
+    std::string material;
+    bool hasMaterial = false; // false -> faces antes de qualquer "usemtl"
+    std::vector<unsigned int> position_indices;
+    std::vector<unsigned int> normal_indices;
+};
+
+// Resultado do parsing de um ficheiro OBJ (índices 1-based, 0 = sem normal)
+struct ObjData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjFaceGroup> groups;
+};
+
+// Tokenizer baseado em ponteiros sobre um único buffer com o ficheiro inteiro.
+// Não há alocações por linha: as coordenadas são lidas com std::from_chars e as
+// faces são trianguladas em leque à medida que são lidas.
+class ObjParser
+{
+public:
+    // Abaixo deste tamanho o parsing paralelo não compensa
+    static constexpr size_t PARALLEL_MIN_BYTES = 4u << 20;
+    static constexpr size_t CHUNK_BYTES = 8u << 20;
+
+    static void parse(const char *begin, const char *end, ObjData &out)
+    {
+        Chunk chunk;
+        chunk.exact = true;
+        chunk.data.groups.emplace_back();
+        parseRange(begin, end, chunk);
+
+        out = std::move(chunk.data);
+        removeOutOfRange(out);
+        removeEmptyGroups(out);
+    }
+
+    // Divide o ficheiro em blocos nas quebras de linha e faz o parsing de cada
+    // bloco numa thread. A junção é feita por ordem dos blocos, por isso o
+    // resultado é idêntico ao de parse(). Devolve o número de threads usadas.
+    static unsigned int parseParallel(const char *begin, const char *end, ObjData &out,
+                                      unsigned int threadCount = 0)
+    {
+        size_t size = end - begin;
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        if (threadCount == 1 || size < PARALLEL_MIN_BYTES)
+        {
+            parse(begin, end, out);
+            return 1;
+        }
+
+        // Blocos mais pequenos que size/threads para equilibrar a carga
+        size_t chunkBytes = std::min(CHUNK_BYTES, size / threadCount + 1);
+        std::vector<const char *> bounds{begin};
+        while (bounds.back() < end)
+        {
+            const char *p = bounds.back() + std::min(chunkBytes, size_t(end - bounds.back()));
+            p = findLineEnd(p, end);
+            bounds.push_back(p < end ? p + 1 : end);
+        }
+
+        size_t chunkCount = bounds.size() - 1;
+        std::vector<Chunk> chunks(chunkCount);
+        std::atomic<size_t> next{0};
+
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < chunkCount; i = next++)
+            {
+                chunks[i].exact = (i == 0);
+                chunks[i].data.groups.emplace_back();
+                parseRange(bounds[i], bounds[i + 1], chunks[i]);
+            }
+        };
+
+        threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, chunkCount));
+        std::vector<std::thread> threads;
+        for (unsigned int t = 1; t < threadCount; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &t : threads)
+            t.join();
+
+        merge(chunks, out);
+        return threadCount;
+    }
+
+private:
+    // Índice relativo (negativo) que só pode ser resolvido depois de se saber
+    // quantos vértices existem nos blocos anteriores
+    struct IndexFixup
+    {
+        size_t group;  // grupo dentro do bloco
+        size_t offset; // posição no array de índices do grupo
+        long local;    // índice 1-based relativo ao início do bloco
+        bool normal;
+    };
+
+    // Intervalo de índices emitido por uma face com índices pendentes, para
+    // a descartar na junção se algum deles não existir (como em parseFace)
+    struct FaceRange
+    {
+        size_t group;
+        size_t begin, end;
+    };
+
+    struct Chunk
+    {
+        ObjData data;
+        std::vector<IndexFixup> fixups;
+        std::vector<FaceRange> pendingFaces;
+        bool exact = false; // true se os contadores locais já são globais
+    };
+
+    static void removeEmptyGroups(ObjData &out)
+    {
+        out.groups.erase(std::remove_if(out.groups.begin(), out.groups.end(),
+                                        [](const ObjFaceGroup &g)
+                                        { return g.position_indices.empty(); }),
+                         out.groups.end());
+    }
+
+    static void merge(std::vector<Chunk> &chunks, ObjData &out)
+    {
+        size_t positionCount = 0, normalCount = 0;
+        for (auto &chunk : chunks)
+        {
+            positionCount += chunk.data.positions.size();
+            normalCount += chunk.data.normals.size();
+        }
+
+        out = ObjData{};
+        out.positions.reserve(positionCount);
+        out.normals.reserve(normalCount);
+        std::vector<FaceRange> invalidFaces; // já nos grupos de out, por ordem
+
+        for (size_t c = 0; c < chunks.size(); ++c)
+        {
+            ObjData &data = chunks[c].data;
+            long positionBase = static_cast<long>(out.positions.size());
+            long normalBase = static_cast<long>(out.normals.size());
+            out.positions.insert(out.positions.end(), data.positions.begin(), data.positions.end());
+            out.normals.insert(out.normals.end(), data.normals.begin(), data.normals.end());
+
+            // Para cada grupo do bloco: grupo de destino e offset dos seus índices
+            std::vector<std::pair<size_t, size_t>> destination(data.groups.size());
+            for (size_t g = 0; g < data.groups.size(); ++g)
+            {
+                ObjFaceGroup &group = data.groups[g];
+                bool continuation = (g == 0 && !group.hasMaterial && !out.groups.empty());
+
+                // mesma regra do parser: um "usemtl" só fecha um grupo com faces
+                if (!continuation && (out.groups.empty() || !out.groups.back().position_indices.empty()))
+                {
+                    out.groups.emplace_back();
+                }
+                ObjFaceGroup &target = out.groups.back();
+                if (!continuation)
+                {
+                    target.material = std::move(group.material);
+                    target.hasMaterial = group.hasMaterial;
+                }
+
+                destination[g] = {out.groups.size() - 1, target.position_indices.size()};
+                if (target.position_indices.empty())
+                {
+                    target.position_indices = std::move(group.position_indices);
+                    target.normal_indices = std::move(group.normal_indices);
+                }
+                else
+                {
+                    target.position_indices.insert(target.position_indices.end(),
+                                                   group.position_indices.begin(), group.position_indices.end());
+                    target.normal_indices.insert(target.normal_indices.end(),
+                                                 group.normal_indices.begin(), group.normal_indices.end());
+                }
+            }
+
+            for (const IndexFixup &fix : chunks[c].fixups)
+            {
+                ObjFaceGroup &target = out.groups[destination[fix.group].first];
+                size_t offset = destination[fix.group].second + fix.offset;
+                long idx = fix.local + (fix.normal ? normalBase : positionBase);
+                (fix.normal ? target.normal_indices : target.position_indices)[offset] =
+                    idx > 0 ? static_cast<unsigned int>(idx) : 0u;
+            }
+
+            for (const FaceRange &face : chunks[c].pendingFaces)
+            {
+                size_t group = destination[face.group].first;
+                size_t begin = destination[face.group].second + face.begin;
+                size_t end = destination[face.group].second + face.end;
+                const std::vector<unsigned int> &positions = out.groups[group].position_indices;
+                if (std::find(positions.begin() + begin, positions.begin() + end, 0u) != positions.begin() + end)
+                    invalidFaces.push_back({group, begin, end});
+            }
+        }
+
+        removeFaces(out, invalidFaces);
+        removeOutOfRange(out);
+        removeEmptyGroups(out);
+    }
+
+    // Índices positivos só podem ser verificados com o ficheiro inteiro lido
+    // (num bloco são globais): retira os triângulos que apontam para além
+    // das posições ou normais existentes. Igual em parse() e na junção.
+    static void removeOutOfRange(ObjData &out)
+    {
+        size_t positionCount = out.positions.size(), normalCount = out.normals.size();
+        for (ObjFaceGroup &group : out.groups)
+        {
+            std::vector<unsigned int> &positions = group.position_indices;
+            std::vector<unsigned int> &normals = group.normal_indices;
+            size_t write = 0;
+            for (size_t read = 0; read + 3 <= positions.size(); read += 3)
+            {
+                bool valid = true;
+                for (size_t k = read; k < read + 3; ++k)
+                    valid = valid && positions[k] <= positionCount && normals[k] <= normalCount;
+                if (!valid)
+                    continue;
+                if (write != read)
+                {
+                    std::copy(positions.begin() + read, positions.begin() + read + 3, positions.begin() + write);
+                    std::copy(normals.begin() + read, normals.begin() + read + 3, normals.begin() + write);
+                }
+                write += 3;
+            }
+            positions.resize(write);
+            normals.resize(write);
+        }
+    }
+
+    // Retira os intervalos dados (ordenados por grupo e posição)
+    static void removeFaces(ObjData &out, const std::vector<FaceRange> &faces)
+    {
+        size_t next = 0;
+        while (next < faces.size())
+        {
+            size_t g = faces[next].group;
+            ObjFaceGroup &group = out.groups[g];
+            size_t write = faces[next].begin, read = faces[next].begin;
+            while (read < group.position_indices.size())
+            {
+                if (next < faces.size() && faces[next].group == g && read == faces[next].begin)
+                {
+                    read = faces[next++].end;
+                    continue;
+                }
+                group.position_indices[write] = group.position_indices[read];
+                group.normal_indices[write] = group.normal_indices[read];
+                ++write;
+                ++read;
+            }
+            group.position_indices.resize(write);
+            group.normal_indices.resize(write);
+        }
+    }
+
+    static const char *findLineEnd(const char *p, const char *end)
+    {
+        while (p < end && *p != '\n')
+            ++p;
+        return p;
+    }
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static const char *skipSpaces(const char *p, const char *end)
+    {
+        while (p < end && isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static const char *tokenEnd(const char *p, const char *end)
+    {
+        while (p < end && !isSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static const char *parseFloat(const char *p, const char *end, float &value)
+    {
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+')
+            ++p;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc())
+            value = 0.0f;
+        return result.ptr;
+    }
+
+    static const char *parseVec3(const char *p, const char *end, glm::vec3 &v)
+    {
+        p = parseFloat(p, end, v.x);
+        p = parseFloat(p, end, v.y);
+        return parseFloat(p, end, v.z);
+    }
+
+    // Índices são inteiros decimais simples; um laço inline é bastante mais
+    // rápido que std::from_chars<long> (que não é inlined pelo libstdc++)
+    static const char *parseInt(const char *p, const char *end, long &value)
+    {
+        bool negative = p < end && *p == '-';
+        if (negative || (p < end && *p == '+'))
+            ++p;
+
+        long v = 0;
+        while (p < end && static_cast<unsigned char>(*p - '0') < 10)
+            v = v * 10 + (*p++ - '0');
+        value = negative ? -v : v;
+        return p;
+    }
+
+    // Converte um índice OBJ (1-based ou negativo/relativo) num índice 1-based.
+    // Num bloco que não é o primeiro, os índices relativos ficam pendentes.
+    static unsigned int resolveIndex(long idx, size_t count, Chunk &chunk, bool normal)
+    {
+        if (idx < 0)
+        {
+            idx += static_cast<long>(count) + 1;
+            if (!chunk.exact)
+            {
+                const ObjFaceGroup &group = chunk.data.groups.back();
+                size_t offset = normal ? group.normal_indices.size() : group.position_indices.size();
+                chunk.fixups.push_back({chunk.data.groups.size() - 1, offset, idx, normal});
+                return 1; // substituído na junção
+            }
+        }
+        return idx > 0 ? static_cast<unsigned int>(idx) : 0u;
+    }
+
+    // Lê um token "v", "v/vt", "v//vn" ou "v/vt/vn"
+    static const char *parseFaceVertex(const char *p, const char *end,
+                                       long &posIdx, long &normIdx)
+    {
+        p = parseInt(p, end, posIdx);
+        normIdx = 0;
+
+        if (p < end && *p == '/')
+        {
+            ++p;
+            while (p < end && *p != '/' && !isSpace(*p))
+                ++p; // vt (ignorado)
+            if (p < end && *p == '/')
+                p = parseInt(p + 1, end, normIdx);
+        }
+        return tokenEnd(p, end);
+    }
+
+    static void pushCorner(Chunk &chunk, long posIdx, long normIdx)
+    {
+        ObjFaceGroup &group = chunk.data.groups.back();
+        unsigned int p = resolveIndex(posIdx, chunk.data.positions.size(), chunk, false);
+        unsigned int n = resolveIndex(normIdx, chunk.data.normals.size(), chunk, true);
+        group.position_indices.push_back(p);
+        group.normal_indices.push_back(n);
+    }
+
+    static void parseFace(const char *p, const char *end, Chunk &chunk)
+    {
+        ObjFaceGroup &group = chunk.data.groups.back();
+
+        long firstP = 0, firstN = 0, prevP = 0, prevN = 0;
+        int count = 0;
+        size_t groupStart = group.position_indices.size();
+        size_t fixupStart = chunk.fixups.size();
+        bool valid = true;
+
+        // Triangulação em Leque: (v0, v[i], v[i+1])
+        for (p = skipSpaces(p, end); p < end; p = skipSpaces(p, end))
+        {
+            long posIdx, normIdx;
+            p = parseFaceVertex(p, end, posIdx, normIdx);
+            valid = valid && posIdx != 0;
+
+            if (count == 0)
+            {
+                firstP = posIdx;
+                firstN = normIdx;
+            }
+            else if (count >= 2)
+            {
+                pushCorner(chunk, firstP, firstN);
+                pushCorner(chunk, prevP, prevN);
+                pushCorner(chunk, posIdx, normIdx);
+            }
+            prevP = posIdx;
+            prevN = normIdx;
+            ++count;
+        }
+
+        // Face com índice inválido: descartar os triângulos emitidos
+        for (size_t i = groupStart; valid && i < group.position_indices.size(); ++i)
+            valid = group.position_indices[i] != 0;
+        if (!valid)
+        {
+            group.position_indices.resize(groupStart);
+            group.normal_indices.resize(groupStart);
+            chunk.fixups.resize(fixupStart);
+        }
+        else if (chunk.fixups.size() > fixupStart)
+        {
+            chunk.pendingFaces.push_back({chunk.data.groups.size() - 1, groupStart, group.position_indices.size()});
+        }
+    }
+
+    static void parseLine(const char *p, const char *end, Chunk &chunk)
+    {
+        p = skipSpaces(p, end);
+        if (p >= end || *p == '#')
+            return;
+
+        const char *prefixEnd = tokenEnd(p, end);
+        size_t prefixLen = prefixEnd - p;
+        ObjData &out = chunk.data;
+
+        if (prefixLen == 1 && p[0] == 'v')
+        {
+            glm::vec3 pos;
+            parseVec3(prefixEnd, end, pos);
+            out.positions.push_back(pos);
+        }
+        else if (prefixLen == 2 && p[0] == 'v' && p[1] == 'n')
+        {
+            glm::vec3 n;
+            parseVec3(prefixEnd, end, n);
+            out.normals.push_back(glm::normalize(n));
+        }
+        else if (prefixLen == 1 && p[0] == 'f')
+        {
+            parseFace(prefixEnd, end, chunk);
+        }
+        else if (prefixLen == 6 && std::char_traits<char>::compare(p, "usemtl", 6) == 0)
+        {
+            const char *name = skipSpaces(prefixEnd, end);
+            const char *nameEnd = tokenEnd(name, end);
+
+            // fecha o grupo anterior só se tiver faces
+            if (!out.groups.back().position_indices.empty())
+                out.groups.emplace_back();
+
+            ObjFaceGroup &group = out.groups.back();
+            group.material.assign(name, nameEnd);
+            group.hasMaterial = true;
+        }
+    }
+
+    static void parseRange(const char *p, const char *end, Chunk &chunk)
+    {
+        while (p < end)
+        {
+            const char *lineEnd = findLineEnd(p, end);
+            parseLine(p, lineEnd, chunk);
+            p = lineEnd + 1;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gl_ext.h"
+
+// Cache em disco dos binários de programas (glGetProgramBinary), um
+// ficheiro por programa em DIRECTORY. A chave junta o código dos shaders,
+// os defines e o vendor/renderer/versão do driver, por isso uma mudança de
+// fonte ou de driver dá outro ficheiro. O driver pode ainda recusar um
+// binário (glProgramBinary sem GL_LINK_STATUS): load() apaga-o e devolve 0,
+// e o programa é compilado do código fonte como sem cache.
+//
+// Layout: Header | binário (header.length bytes, formato header.format)
+class ProgramCache
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr const char *DIRECTORY = "shaders/cache";
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t format; // binaryFormat devolvido pelo driver
+        uint64_t key;
+        uint64_t length;
+    };
+
+    static_assert(sizeof(Header) == 32, "Header do .glprog mudou de tamanho");
+
+    // Programas desde o arranque: lidos da cache, compilados e recusados
+    static inline unsigned int loadedPrograms = 0;
+    static inline unsigned int compiledPrograms = 0;
+    static inline unsigned int rejectedPrograms = 0;
+
+    // Thread de GL (lê as strings do driver)
+    static uint64_t key(const std::string &vertexCode, const std::string &fragmentCode, const std::string &defines)
+    {
+        uint64_t h = hashString(driverString(), 0xCBF29CE484222325ull ^ VERSION);
+        h = hashString(defines, h);
+        h = hashString(vertexCode, h);
+        h = hashString(fragmentCode, h);
+        return h;
+    }
+
+    static std::string path(uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.glprog", (unsigned long long)key);
+        return std::string(DIRECTORY) + "/" + name;
+    }
+
+    // Programa ligado a partir do binário guardado, ou 0 se não há cache,
+    // o ficheiro não serve ou o driver o recusou
+    static GLuint load(uint64_t key)
+    {
+        if (!glext_ARB_get_program_binary)
+            return 0;
+
+        std::string filePath = path(key);
+        std::ifstream file(filePath, std::ios::binary);
+        Header header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            return 0;
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.key != key || header.length == 0 || header.length > MAX_BINARY_SIZE)
+            return 0;
+
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), binary.size()))
+            return 0;
+        file.close();
+
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            std::cout << "WARNING: program binary " << filePath << " rejected by the driver, compiling from source"
+                      << std::endl;
+            glDeleteProgram(program);
+            std::error_code ignored;
+            std::filesystem::remove(filePath, ignored);
+            ++rejectedPrograms;
+            return 0;
+        }
+        ++loadedPrograms;
+        return program;
+    }
+
+    // Guarda o binário de um programa já ligado (com
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT antes do link)
+    static bool store(uint64_t key, GLuint program)
+    {
+        if (!glext_ARB_get_program_binary)
+            return false;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return false;
+
+        std::vector<char> binary(length);
+        GLsizei written = 0;
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return false;
+
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.format = format;
+        header.key = key;
+        header.length = (uint64_t)written;
+
+        std::error_code ec;
+        std::filesystem::create_directories(DIRECTORY, ec);
+        std::string filePath = path(key);
+        std::string tmpPath = filePath + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return false;
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(binary.data(), written);
+            if (!file.good())
+                return false;
+        }
+
+        std::filesystem::rename(tmpPath, filePath, ec);
+        if (ec)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(tmpPath, ignored);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'B', 'O', 'A', 'T', 'P', 'R', 'G', '\0'};
+    static constexpr uint64_t MAX_BINARY_SIZE = 64ull * 1024 * 1024;
+
+    // FNV-1a; os shaders são pequenos e só se calcula no arranque
+    static uint64_t hashString(const std::string &s, uint64_t h)
+    {
+        for (unsigned char c : s)
+            h = (h ^ c) * 0x100000001B3ull;
+        return (h ^ s.size()) * 0x100000001B3ull;
+    }
+
+    static const std::string &driverString()
+    {
+        static const std::string driver = [] {
+            std::string s;
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+            {
+                const char *value = (const char *)glGetString(name);
+                s += value ? value : "";
+                s += '\n';
+            }
+            return s;
+        }();
+        return driver;
+    }
+};
+
+#endif
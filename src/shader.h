@@ -3,19 +3,132 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gl_ext.h"
+#include "program_cache.h"
+
+// Tipo GLSL de cada tipo C++ aceite por Uniform<T>
+template <typename T>
+struct UniformType;
+template <>
+struct UniformType<bool>
+{
+    static constexpr GLenum value = GL_BOOL;
+};
+template <>
+struct UniformType<int>
+{
+    static constexpr GLenum value = GL_INT;
+};
+template <>
+struct UniformType<float>
+{
+    static constexpr GLenum value = GL_FLOAT;
+};
+template <>
+struct UniformType<glm::vec2>
+{
+    static constexpr GLenum value = GL_FLOAT_VEC2;
+};
+template <>
+struct UniformType<glm::vec3>
+{
+    static constexpr GLenum value = GL_FLOAT_VEC3;
+};
+template <>
+struct UniformType<glm::vec4>
+{
+    static constexpr GLenum value = GL_FLOAT_VEC4;
+};
+template <>
+struct UniformType<glm::mat4>
+{
+    static constexpr GLenum value = GL_FLOAT_MAT4;
+};
+
+// #defines de uma variante (nome, valor), injetados a seguir ao #version de
+// cada shader; a ordem conta para a chave (ShaderVariants)
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+// Blocking: o construtor só volta com o programa ligado. Async: o construtor
+// só submete a compilação; poll() diz, sem bloquear, quando está pronto.
+enum class ShaderBuildMode
+{
+    Blocking,
+    Async
+};
+
+// Uniform já resolvido (ver Shader::uniform): set() é uma só chamada
+// glUniform* sobre o programa em uso, sem procurar o nome. Um handle vazio
+// (uniform inexistente ou eliminado pelo compilador) ignora set(), como o
+// glUniform com location -1.
+template <typename T>
+class Uniform
+{
+public:
+    Uniform() = default;
+    explicit Uniform(GLint location) : location(location) {}
+
+    bool isValid() const { return location >= 0; }
+
+    void set(const T &value) const
+    {
+        if (location >= 0)
+            upload(location, value);
+    }
+
+private:
+    GLint location = -1;
+
+    static void upload(GLint l, bool v) { glUniform1i(l, (int)v); }
+    static void upload(GLint l, int v) { glUniform1i(l, v); }
+    static void upload(GLint l, float v) { glUniform1f(l, v); }
+    static void upload(GLint l, const glm::vec2 &v) { glUniform2fv(l, 1, &v[0]); }
+    static void upload(GLint l, const glm::vec3 &v) { glUniform3fv(l, 1, &v[0]); }
+    static void upload(GLint l, const glm::vec4 &v) { glUniform4fv(l, 1, &v[0]); }
+    static void upload(GLint l, const glm::mat4 &v) { glUniformMatrix4fv(l, 1, GL_FALSE, &v[0][0]); }
+};
 
 class Shader
 {
 public:
     unsigned int ID;
 
-    // Construtor: lê e compila os shaders
-    Shader(const char *vertexPath, const char *fragmentPath)
+    // Uniform ativo do bloco por omissão, lido do programa depois do link
+    struct UniformInfo
+    {
+        GLint location;
+        GLenum type;
+        GLint arraySize;
+    };
+
+    // Compilação submetida ao driver e ainda não verificada
+    struct PendingProgram
+    {
+        unsigned int program = 0;
+        unsigned int vertex = 0, fragment = 0;
+        uint64_t key = 0;
+        bool compiling = false; // por verificar; false se veio da ProgramCache
+    };
+
+    std::string label; // ficheiro do fragment shader e defines, para os logs
+    std::chrono::duration<double> buildTime{0.0}; // da submissão até estar pronto
+
+    // Construtor: lê e compila os shaders, com os defines da variante
+    Shader(const char *vertexPath, const char *fragmentPath, const ShaderDefines &defines = {},
+           ShaderBuildMode mode = ShaderBuildMode::Blocking)
     {
+        auto submitted = std::chrono::high_resolution_clock::now();
         std::string vertexCode;
         std::string fragmentCode;
         std::ifstream vShaderFile;
@@ -45,33 +158,148 @@ public:
                       << e.what() << std::endl;
         }
 
+        label = fragmentPath;
+        if (!defines.empty())
+        {
+            label += " [";
+            for (size_t i = 0; i < defines.size(); ++i)
+                label += (i ? " " : "") + defines[i].first + "=" + defines[i].second;
+            label += "]";
+        }
+
+        std::string defineBlock = defineLines(defines);
+        submitTime = submitted;
+        pending = submitProgram(injectDefines(vertexCode, defineBlock), injectDefines(fragmentCode, defineBlock),
+                                defineBlock);
+        ID = pending.program;
+        if (mode == ShaderBuildMode::Blocking)
+            finish();
+    }
+
+    // Termina a compilação se o driver já a acabou (nunca bloqueia com
+    // KHR_parallel_shader_compile; sem a extensão termina-a já, como em
+    // Blocking). Até devolver true o programa não pode ser usado.
+    bool poll()
+    {
+        if (!ready && isComplete(pending))
+            finish();
+        return ready;
+    }
+
+    // Espera pelo driver, se preciso, e deixa o programa pronto a usar
+    void finish()
+    {
+        if (ready)
+            return;
+        finishProgram(pending);
+        reflectUniforms();
+        buildTime = std::chrono::high_resolution_clock::now() - submitTime;
+        ready = true;
+    }
+
+    bool isReady() const { return ready; }
+
+    // "#define NOME VALOR" por linha, pela ordem dada
+    static std::string defineLines(const ShaderDefines &defines)
+    {
+        std::string lines;
+        for (const auto &define : defines)
+            lines += "#define " + define.first + " " + define.second + "\n";
+        return lines;
+    }
+
+    // Insere os defines a seguir à linha do #version (que tem de ser a
+    // primeira diretiva); o #line mantém os números de linha dos erros
+    static std::string injectDefines(const std::string &code, const std::string &defineBlock)
+    {
+        if (defineBlock.empty())
+            return code;
+
+        size_t version = code.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : code.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return defineBlock + "#line 1\n" + code;
+
+        size_t insertAt = lineEnd + 1;
+        size_t nextLine = std::count(code.begin(), code.begin() + insertAt, '\n') + 1;
+        return code.substr(0, insertAt) + defineBlock + "#line " + std::to_string(nextLine) + "\n" +
+               code.substr(insertAt);
+    }
+
+    // Programa ligado a partir do código dos dois shaders: vem da
+    // ProgramCache quando o binário existe e o driver o aceita; senão é
+    // compilado e o binário guardado para o próximo arranque
+    static unsigned int buildProgram(const std::string &vertexCode, const std::string &fragmentCode,
+                                     const std::string &defines = "")
+    {
+        PendingProgram pending = submitProgram(vertexCode, fragmentCode, defines);
+        return finishProgram(pending);
+    }
+
+    // Primeira metade de buildProgram: pede a compilação e o link sem ler o
+    // estado de nenhum deles, o que obrigaria o driver a terminá-los já
+    static PendingProgram submitProgram(const std::string &vertexCode, const std::string &fragmentCode,
+                                        const std::string &defines)
+    {
+        PendingProgram pending;
+        pending.key = ProgramCache::key(vertexCode, fragmentCode, defines);
+        pending.program = ProgramCache::load(pending.key);
+        if (pending.program)
+            return pending;
+
         const char *vShaderCode = vertexCode.c_str();
         const char *fShaderCode = fragmentCode.c_str();
 
-        // Compilar shaders
-        unsigned int vertex, fragment;
-
         // Vertex Shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        pending.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending.vertex, 1, &vShaderCode, NULL);
+        glCompileShader(pending.vertex);
 
         // Fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        pending.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending.fragment, 1, &fShaderCode, NULL);
+        glCompileShader(pending.fragment);
 
         // Shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        pending.program = glCreateProgram();
+        pending.compiling = true;
+        if (glext_ARB_get_program_binary)
+            glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(pending.program, pending.vertex);
+        glAttachShader(pending.program, pending.fragment);
+        glLinkProgram(pending.program);
+        return pending;
+    }
+
+    // true se finishProgram já não vai esperar pelo driver; sem
+    // KHR_parallel_shader_compile não há como saber sem bloquear
+    static bool isComplete(const PendingProgram &pending)
+    {
+        if (!pending.compiling || !glext_KHR_parallel_shader_compile)
+            return true;
+        GLint complete = GL_FALSE;
+        glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+        return complete == GL_TRUE;
+    }
+
+    // Segunda metade: erros de compilação/link e binário para a ProgramCache
+    static unsigned int finishProgram(PendingProgram &pending)
+    {
+        if (!pending.compiling)
+            return pending.program;
+
+        checkCompileErrors(pending.vertex, "VERTEX");
+        checkCompileErrors(pending.fragment, "FRAGMENT");
+        bool linked = checkCompileErrors(pending.program, "PROGRAM");
 
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+        pending.vertex = pending.fragment = 0;
+        pending.compiling = false;
+        ++ProgramCache::compiledPrograms;
+        if (linked)
+            ProgramCache::store(pending.key, pending.program);
+        return pending.program;
     }
 
     void use()
@@ -79,39 +307,127 @@ public:
         glUseProgram(ID);
     }
 
-    // Funções para definir uniforms
+    // Handle para o uniform name, resolvido uma vez (guardar e reutilizar
+    // a cada frame). Vazio se o programa não o usa ou se o tipo GLSL não
+    // corresponde a T (com aviso).
+    template <typename T>
+    Uniform<T> uniform(const std::string &name) const
+    {
+        const UniformInfo *info = find(name);
+        if (!info)
+            return Uniform<T>();
+
+        // samplers são inteiros do lado da API
+        GLenum expected = UniformType<T>::value;
+        bool sampler = expected == GL_INT && isSampler(info->type);
+        if (info->type != expected && !sampler)
+        {
+            std::cout << "WARNING: uniform " << name << " of program " << ID << " has GL type 0x"
+                      << std::hex << info->type << ", not 0x" << expected << std::dec << std::endl;
+            return Uniform<T>();
+        }
+        return Uniform<T>(info->location);
+    }
+
+    const std::unordered_map<std::string, UniformInfo> &activeUniforms() const { return uniforms; }
+
+    // Funções para definir uniforms pelo nome (procuram na tabela refletida
+    // em cada chamada; no ciclo de render usar uniform<T>())
     void setBool(const std::string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(location(name), (int)value);
     }
 
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(location(name), value);
     }
 
     void setFloat(const std::string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(location(name), value);
     }
 
     void setVec3(const std::string &name, const glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(location(name), 1, &value[0]);
     }
 
     void setVec3(const std::string &name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(location(name), x, y, z);
     }
 
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
-    void checkCompileErrors(unsigned int shader, std::string type)
+    std::unordered_map<std::string, UniformInfo> uniforms;
+    PendingProgram pending;
+    std::chrono::high_resolution_clock::time_point submitTime;
+    bool ready = false;
+
+    // Todos os uniforms ativos fora de blocos, com a location já resolvida.
+    // Os arrays ficam também com o nome sem "[0]".
+    void reflectUniforms()
+    {
+        uniforms.clear();
+        GLint count = 0, maxNameLength = 0;
+        glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+        glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_MAX_NAME_LENGTH, &maxNameLength);
+
+        static const GLenum props[] = {GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE};
+        std::vector<GLchar> name(std::max(maxNameLength, 1));
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLint values[4] = {-1, -1, 0, 0};
+            glGetProgramResourceiv(ID, GL_UNIFORM, (GLuint)i, 4, props, 4, nullptr, values);
+            if (values[0] != -1 || values[1] < 0)
+                continue; // membro de um bloco uniforme ou de armazenamento
+
+            GLsizei length = 0;
+            glGetProgramResourceName(ID, GL_UNIFORM, (GLuint)i, (GLsizei)name.size(), &length, name.data());
+            std::string uniformName(name.data(), length);
+            UniformInfo info = {values[1], (GLenum)values[2], values[3]};
+            uniforms[uniformName] = info;
+            if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+                uniforms[uniformName.substr(0, uniformName.size() - 3)] = info;
+        }
+    }
+
+    const UniformInfo *find(const std::string &name) const
+    {
+        auto it = uniforms.find(name);
+        return it != uniforms.end() ? &it->second : nullptr;
+    }
+
+    GLint location(const std::string &name) const
+    {
+        const UniformInfo *info = find(name);
+        return info ? info->location : -1;
+    }
+
+    static bool isSampler(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_BUFFER:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -137,7 +453,41 @@ private:
                           << std::endl;
             }
         }
+        return success != 0;
     }
 };
 
-#endif
\ No newline at end of file
+// Variantes de um par de shaders, uma por conjunto de defines: cada uma é
+// compilada (ou restaurada da ProgramCache) na primeira vez que é pedida e
+// fica guardada, por isso trocar de variante depois disso não custa nada.
+// Em Async a variante devolvida pode ainda não estar pronta (Shader::poll).
+class ShaderVariants
+{
+public:
+    ShaderVariants(std::string vertexPath, std::string fragmentPath)
+        : vertexPath(std::move(vertexPath)), fragmentPath(std::move(fragmentPath))
+    {
+    }
+
+    Shader &get(const ShaderDefines &defines, ShaderBuildMode mode = ShaderBuildMode::Blocking)
+    {
+        std::string key = Shader::defineLines(defines);
+        auto it = variants.find(key);
+        if (it == variants.end())
+        {
+            auto shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), defines, mode);
+            it = variants.emplace(key, std::move(shader)).first;
+        }
+        else if (mode == ShaderBuildMode::Blocking)
+            it->second->finish();
+        return *it->second;
+    }
+
+    size_t size() const { return variants.size(); }
+
+private:
+    std::string vertexPath, fragmentPath;
+    std::unordered_map<std::string, std::unique_ptr<Shader>> variants;
+};
+
+#endif
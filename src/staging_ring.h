@@ -0,0 +1,222 @@
+#ifndef STAGING_RING_H
+#define STAGING_RING_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+
+#include "gl_ext.h"
+
+// Anel de staging num buffer com mapeamento persistente e coerente
+// (ARB_buffer_storage). write() pode ser chamado de qualquer thread: copia
+// os dados para o anel e agenda a cópia para o buffer de destino. submit(),
+// no thread de GL uma vez por frame, emite as cópias pendentes com
+// glCopyBufferSubData até ao limite de bytes por frame e protege cada lote
+// com um fence; o espaço só volta a ser usado quando a GPU passa o fence.
+class StagingRing
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 8 * 1024 * 1024;
+    static constexpr size_t DEFAULT_FRAME_BUDGET = 2 * 1024 * 1024;
+
+    StagingRing() = default;
+    StagingRing(const StagingRing &) = delete;
+    StagingRing &operator=(const StagingRing &) = delete;
+
+    ~StagingRing()
+    {
+        destroy();
+    }
+
+    // Thread de GL. Devolve false (e o anel fica indisponível) sem
+    // ARB_buffer_storage; nesse caso o upload faz-se com glBufferSubData.
+    bool create(size_t capacityBytes = DEFAULT_CAPACITY, size_t frameBudgetBytes = DEFAULT_FRAME_BUDGET)
+    {
+        destroy();
+        if (!glext_ARB_buffer_storage)
+        {
+            std::cout << "WARNING: ARB_buffer_storage not available, uploads will not use the staging ring" << std::endl;
+            return false;
+        }
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBufferStorage(GL_COPY_READ_BUFFER, capacityBytes, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+        mapped = static_cast<char *>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, capacityBytes, flags));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        if (!mapped)
+        {
+            std::cout << "WARNING: could not map the staging ring" << std::endl;
+            destroy();
+            return false;
+        }
+
+        capacity = capacityBytes;
+        frameBudget = frameBudgetBytes;
+        head = used = 0;
+        std::cout << "Staging ring: " << capacity / 1024 << " KB, "
+                  << frameBudget / 1024 << " KB per frame" << std::endl;
+        return true;
+    }
+
+    void destroy()
+    {
+        if (!buffer)
+            return;
+        for (const Batch &batch : batches)
+            glDeleteSync(batch.fence);
+        batches.clear();
+        pending.clear();
+
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        mapped = nullptr;
+    }
+
+    bool isAvailable() const { return mapped != nullptr; }
+
+    // Qualquer thread. Devolve false se o anel não tem espaço agora (tentar
+    // de novo depois de um submit); ticket identifica a cópia para
+    // isSubmitted(). dst tem de ser um buffer já criado no thread de GL.
+    bool write(GLuint dst, size_t dstOffset, const void *data, size_t size, uint64_t &ticket)
+    {
+        size_t aligned = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        char *target;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!mapped || aligned > capacity)
+                return false;
+
+            if (used == 0)
+                head = 0;
+
+            // Sem espaço contíguo até ao fim: salta para o início e conta o
+            // resto do anel como ocupado por esta região
+            size_t padding = head + aligned > capacity ? capacity - head : 0;
+            if (used + padding + aligned > capacity)
+                return false;
+
+            size_t offset = padding ? 0 : head;
+            head = (offset + aligned) % capacity;
+            used += padding + aligned;
+
+            ticket = nextTicket++;
+            pending.push_back({ticket, offset, size, padding + aligned, dst, dstOffset, false});
+            target = mapped + offset;
+        }
+
+        std::memcpy(target, data, size);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+        {
+            if (it->ticket == ticket)
+            {
+                it->written = true;
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Thread de GL, uma vez por frame: liberta os lotes já terminados pela
+    // GPU e emite as cópias prontas (por ordem) até frameBudget bytes, pelo
+    // menos uma
+    void submit()
+    {
+        if (!mapped)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!batches.empty())
+        {
+            GLenum status = glClientWaitSync(batches.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            glDeleteSync(batches.front().fence);
+            used -= batches.front().bytes;
+            batches.pop_front();
+        }
+
+        size_t copied = 0, span = 0;
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        while (!pending.empty() && pending.front().written && (copied == 0 || copied + pending.front().size <= frameBudget))
+        {
+            const Copy &copy = pending.front();
+            if (copy.dst)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, copy.dst);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copy.ringOffset, copy.dstOffset, copy.size);
+                copied += copy.size;
+            }
+            span += copy.span;
+            submittedTicket = copy.ticket + 1;
+            pending.pop_front();
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        if (span > 0)
+            batches.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), span});
+        frameBytes = copied;
+    }
+
+    // Thread de GL. Cancela as cópias ainda não emitidas para dst (antes de
+    // apagar o buffer); o espaço no anel é libertado como de costume
+    void discard(GLuint dst)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Copy &copy : pending)
+            if (copy.dst == dst)
+                copy.dst = 0;
+    }
+
+    // A cópia já foi emitida (comandos GL seguintes veem os dados)
+    bool isSubmitted(uint64_t ticket) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ticket < submittedTicket;
+    }
+
+    // Bytes copiados no último submit()
+    size_t lastFrameBytes() const { return frameBytes; }
+
+private:
+    static constexpr size_t ALIGNMENT = 16;
+
+    struct Copy
+    {
+        uint64_t ticket;
+        size_t ringOffset;
+        size_t size;
+        size_t span; // bytes ocupados no anel (alinhamento e salto para o início incluídos)
+        GLuint dst; // 0 depois de discard()
+        size_t dstOffset;
+        bool written; // memcpy terminado
+    };
+
+    struct Batch
+    {
+        GLsync fence;
+        size_t bytes;
+    };
+
+    GLuint buffer = 0;
+    char *mapped = nullptr;
+    size_t capacity = 0, frameBudget = 0;
+    size_t head = 0, used = 0; // regiões ocupadas: os used bytes antes de head (circular)
+    size_t frameBytes = 0;
+    uint64_t nextTicket = 0, submittedTicket = 0;
+    std::deque<Copy> pending;
+    std::deque<Batch> batches;
+    mutable std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,709 @@
+#ifndef STREAMING_MESH_H
+#define STREAMING_MESH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gl_ext.h"
+#include "frustum.h"
+#include "hlod_file.h"
+#include "indirect_draw.h"
+#include "mesh_types.h"
+#include "staging_ring.h"
+#include "vertex_quantizer.h"
+
+// Sub-alocação first-fit de [0, capacidade) em unidades (vértices ou
+// índices), com junção dos blocos livres vizinhos
+class RangeAllocator
+{
+public:
+    void reset(size_t capacityUnits)
+    {
+        capacity = capacityUnits;
+        used = 0;
+        freeRanges.clear();
+        if (capacity > 0)
+            freeRanges[0] = capacity;
+    }
+
+    bool allocate(size_t size, size_t &offset)
+    {
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+        {
+            if (it->second < size)
+                continue;
+            offset = it->first;
+            size_t remaining = it->second - size;
+            freeRanges.erase(it);
+            if (remaining > 0)
+                freeRanges[offset + size] = remaining;
+            used += size;
+            return true;
+        }
+        return false;
+    }
+
+    void release(size_t offset, size_t size)
+    {
+        used -= size;
+        auto next = freeRanges.lower_bound(offset);
+        if (next != freeRanges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next = freeRanges.erase(next);
+        }
+        if (next != freeRanges.begin())
+        {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset)
+            {
+                previous->second += size;
+                return;
+            }
+        }
+        freeRanges[offset] = size;
+    }
+
+    size_t usedUnits() const { return used; }
+    size_t capacityUnits() const { return capacity; }
+
+private:
+    std::map<size_t, size_t> freeRanges; // início -> tamanho
+    size_t capacity = 0, used = 0;
+};
+
+// Modelo lido em streaming de um .boathlod (ver HlodFile), para cascos com
+// mais triângulos do que cabem na memória. Só as tabelas dos nós ficam em
+// RAM; a geometria de cada nó é lida do disco por uma thread de trabalho
+// (até cpuBudget bytes à espera de upload) e enviada para um VBO/EBO de
+// tamanho fixo (gpuBudget bytes), de onde saem os nós usados há mais tempo.
+//
+// selectNodes() desce cada árvore enquanto o erro projetado de um nó passar
+// de maxPixelError pixels e os filhos dentro do frustum estiverem
+// residentes; se faltar algum, desenha o próprio nó e pede os filhos por
+// ordem de erro no ecrã. Um nó só é carregado com o pai residente e só sai
+// sem filhos carregados, por isso há sempre um antepassado para desenhar no
+// lugar do que falta (as raízes nunca saem) e o frame nunca espera pelo
+// disco.
+//
+// O desenho é o do Mesh (IndirectDraw): um comando indireto por nó, com o
+// índice do nó em baseInstance para o DrawData (desquantização) e o
+// material da árvore. Só no thread de GL; a thread de leitura é interna.
+class StreamingMesh
+{
+public:
+    static constexpr size_t DEFAULT_GPU_BUDGET = 256 * 1024 * 1024;
+    static constexpr size_t DEFAULT_CPU_BUDGET = 32 * 1024 * 1024;
+
+    // Tempo máximo de upload por frame
+    static constexpr double UPLOAD_BUDGET_MS = 2.0;
+
+    // Volume envolvente de todas as árvores no espaço do modelo
+    Bounds bounds;
+
+    // Resultado do último selectNodes
+    size_t drawnNodes = 0;
+    size_t drawnTriangles = 0;
+    size_t requestedNodes = 0; // em falta no frame (pedidos ou a caminho)
+
+    StreamingMesh(const char *filepath, size_t gpuBudgetBytes = DEFAULT_GPU_BUDGET,
+                  size_t cpuBudgetBytes = DEFAULT_CPU_BUDGET)
+        : sourcePath(filepath), cpuBudget(cpuBudgetBytes)
+    {
+        if (!HlodFile::readIndex(sourcePath, trees, nodes))
+        {
+            std::cout << "ERROR: could not open streaming mesh " << sourcePath << std::endl;
+            return;
+        }
+        state.assign(nodes.size(), NodeState{});
+
+        // O orçamento da GPU é repartido entre VBO e EBO na proporção do
+        // ficheiro
+        uint64_t vertexBytes = 0, indexBytes = 0, leafTriangles = 0;
+        for (const HlodFile::NodeRecord &node : nodes)
+        {
+            vertexBytes += uint64_t(node.vertexCount) * sizeof(PackedVertex);
+            indexBytes += uint64_t(node.indexCount) * sizeof(unsigned int);
+            leafTriangles += HlodFile::isLeaf(node) ? node.indexCount / 3 : 0;
+        }
+        double vertexShare = (double)vertexBytes / (double)std::max<uint64_t>(vertexBytes + indexBytes, 1);
+        vertexAllocator.reset((size_t)(gpuBudgetBytes * vertexShare) / sizeof(PackedVertex));
+        indexAllocator.reset((size_t)(gpuBudgetBytes * (1.0 - vertexShare)) / sizeof(unsigned int));
+
+        createBuffers();
+
+        // Raízes residentes desde o início, lidas e enviadas já
+        std::ifstream file(sourcePath, std::ios::binary);
+        std::vector<char> data;
+        bool first = true;
+        for (const HlodFile::TreeRecord &tree : trees)
+        {
+            const HlodFile::NodeRecord &root = nodes[tree.root];
+            if (!HlodFile::readNode(file, root, data) || !allocate(tree.root))
+            {
+                std::cout << "ERROR: could not load the root nodes of " << sourcePath
+                          << " (GPU budget too small?)" << std::endl;
+                destroyBuffers();
+                return;
+            }
+            uploadNode(tree.root, data, nullptr);
+
+            glm::vec3 minP(root.boundsMin[0], root.boundsMin[1], root.boundsMin[2]);
+            glm::vec3 maxP(root.boundsMax[0], root.boundsMax[1], root.boundsMax[2]);
+            bounds = first ? Bounds::fromBox(minP, maxP)
+                           : Bounds::fromBox(glm::min(bounds.min, minP), glm::max(bounds.max, maxP));
+            first = false;
+        }
+
+        loader = std::thread([this]()
+                             { loadNodes(); });
+
+        std::cout << "Opened streaming mesh " << sourcePath << ": " << nodes.size() << " nodes in " << trees.size()
+                  << (trees.size() == 1 ? " tree, " : " trees, ") << leafTriangles << " triangles, "
+                  << std::fixed << std::setprecision(2) << (vertexBytes + indexBytes) / (1024.0 * 1024.0)
+                  << " MB on disk; GPU budget " << gpuBudgetBytes / (1024.0 * 1024.0) << " MB, CPU budget "
+                  << cpuBudget / (1024.0 * 1024.0) << " MB" << std::defaultfloat << std::endl;
+    }
+
+    // Dono dos buffers de GL e da thread de leitura: não se copia
+    StreamingMesh(const StreamingMesh &) = delete;
+    StreamingMesh &operator=(const StreamingMesh &) = delete;
+
+    // Thread de GL, com o contexto ainda ativo (o anel usado em update()
+    // tem de viver mais do que o StreamingMesh)
+    ~StreamingMesh()
+    {
+        if (loader.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            loader.join();
+        }
+        if (!VAO)
+            return;
+
+        if (uploadRing)
+        {
+            uploadRing->discard(VBO);
+            uploadRing->discard(EBO);
+        }
+        destroyBuffers();
+        std::cout << "Released streaming mesh " << sourcePath << std::endl;
+    }
+
+    bool isOpen() const { return VAO != 0; }
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t residentNodes() const { return residentCount; }
+
+    // Bytes ocupados e disponíveis no VBO/EBO
+    size_t residentBytes() const
+    {
+        return vertexAllocator.usedUnits() * sizeof(PackedVertex) + indexAllocator.usedUnits() * sizeof(unsigned int);
+    }
+
+    size_t gpuBudget() const
+    {
+        return vertexAllocator.capacityUnits() * sizeof(PackedVertex) +
+               indexAllocator.capacityUnits() * sizeof(unsigned int);
+    }
+
+    // Thread de GL, uma vez por frame (antes de selectNodes): envia os nós
+    // que a thread de leitura já trouxe, durante no máximo budgetMs (pelo
+    // menos um nó), expulsando os menos usados quando o VBO/EBO está
+    // cheio. Com um StagingRing as cópias vão pelo anel e o nó só é
+    // desenhado depois do ring->submit() que as emite.
+    void update(double budgetMs = UPLOAD_BUDGET_MS, StagingRing *ring = nullptr)
+    {
+        if (!VAO)
+            return;
+
+        for (size_t i = 0; i < uploading.size();)
+        {
+            uint32_t id = uploading[i];
+            if (uploadRing && !uploadRing->isSubmitted(state[id].ticket))
+            {
+                ++i;
+                continue;
+            }
+            state[id].status = NodeStatus::Resident;
+            residentCount++;
+            uploading[i] = uploading.back();
+            uploading.pop_back();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (LoadedNode &loaded : completed)
+                arrived.push_back(std::move(loaded));
+            completed.clear();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool staged = ring && ring->isAvailable();
+        size_t released = 0;
+        size_t i = 0;
+        for (; i < arrived.size(); ++i)
+        {
+            LoadedNode &loaded = arrived[i];
+            NodeState &node = state[loaded.node];
+            if (!loaded.allocated)
+            {
+                // falhou a leitura (não volta a ser pedido; o pai fica no
+                // lugar dele) ou já ninguém o pede (volta a Absent)
+                if (loaded.data.empty() || frame - node.lastRequested > STALE_FRAMES)
+                {
+                    node.status = loaded.data.empty() ? NodeStatus::Failed : NodeStatus::Absent;
+                    released += HlodFile::dataSize(nodes[loaded.node]);
+                    loaded.data = std::vector<char>();
+                    continue;
+                }
+                if (!allocate(loaded.node) && !(evictFor(loaded.node) && allocate(loaded.node)))
+                    break; // tudo o que está residente é preciso: espera
+                loaded.allocated = true;
+            }
+
+            if (!uploadNode(loaded.node, loaded.data, staged ? ring : nullptr, &loaded.verticesWritten))
+                break; // anel cheio: continua no próximo frame
+            released += HlodFile::dataSize(nodes[loaded.node]);
+            loaded.data = std::vector<char>();
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budgetMs)
+            {
+                ++i;
+                break;
+            }
+        }
+
+        // Tira os já tratados (enviados ou descartados) da fila
+        arrived.erase(std::remove_if(arrived.begin(), arrived.begin() + i,
+                                     [](const LoadedNode &loaded) { return loaded.data.empty(); }),
+                      arrived.begin() + i);
+
+        if (released > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                cpuBytes -= released;
+            }
+            wake.notify_one();
+        }
+    }
+
+    // Escolhe os nós a desenhar e pede à thread de leitura os que faltam.
+    // viewPos é a posição da câmara no mundo; fovY em radianos.
+    void selectNodes(const glm::mat4 &viewProjection, const glm::mat4 &model, const glm::vec3 &viewPos,
+                     float fovY, float viewportHeight, float maxPixelError = 1.0f)
+    {
+        drawList.clear();
+        drawnNodes = drawnTriangles = requestedNodes = 0;
+        if (!VAO)
+            return;
+        frame++;
+
+        // Tudo no espaço do modelo: o erro e a distância estão nas mesmas
+        // unidades, por isso a escala do modelo não entra na razão
+        Frustum frustum = Frustum::fromMatrix(viewProjection * model);
+        glm::vec3 cameraPos = glm::vec3(glm::inverse(model) * glm::vec4(viewPos, 1.0f));
+        float pixelsPerUnit = viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+
+        wanted.clear();
+        stack.clear();
+        for (const HlodFile::TreeRecord &tree : trees)
+            if (nodeVisible(frustum, nodes[tree.root]))
+                stack.push_back(tree.root);
+
+        while (!stack.empty())
+        {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            const HlodFile::NodeRecord &node = nodes[id];
+            state[id].lastUsed = frame;
+
+            glm::vec3 center = nodeCenter(node);
+            float distance = std::max(glm::length(cameraPos - center) - node.radius, 1e-3f);
+            float pixelError = node.error * pixelsPerUnit / distance;
+            if (HlodFile::isLeaf(node) || pixelError <= maxPixelError)
+            {
+                drawList.push_back(id);
+                continue;
+            }
+
+            // Só desce quando todos os filhos visíveis estão prontos, para
+            // a região nunca ficar com buracos
+            bool childrenReady = true;
+            for (uint32_t child : node.children)
+            {
+                if (!nodeVisible(frustum, nodes[child]) || state[child].status == NodeStatus::Resident)
+                    continue;
+                childrenReady = false;
+                state[child].lastRequested = frame;
+                wanted.push_back({pixelError, child});
+            }
+            if (!childrenReady)
+            {
+                drawList.push_back(id);
+                continue;
+            }
+            for (uint32_t child : node.children)
+                if (nodeVisible(frustum, nodes[child]))
+                    stack.push_back(child);
+        }
+
+        for (uint32_t id : drawList)
+            drawnTriangles += nodes[id].indexCount / 3;
+        drawnNodes = drawList.size();
+        requestedNodes = wanted.size();
+        requestLoads();
+    }
+
+    // Os nós escolhidos em (no máximo) duas chamadas, como Mesh::Draw:
+    // primeiro as árvores com back-face culling, depois as de dupla face.
+    // Deixa GL_CULL_FACE desligado.
+    void Draw()
+    {
+        if (!VAO)
+            return;
+
+        updateDrawCommands();
+        draws.draw(VAO);
+    }
+
+private:
+    // Absent -> Requested (na fila ou a ser lido) -> Uploading (cópias no
+    // anel) -> Resident; um nó lido fica Requested até ao upload. Failed:
+    // erro de leitura, não volta a ser pedido.
+    enum class NodeStatus : unsigned char
+    {
+        Absent,
+        Requested,
+        Uploading,
+        Resident,
+        Failed
+    };
+
+    struct NodeState
+    {
+        NodeStatus status = NodeStatus::Absent;
+        uint64_t lastUsed = 0;      // último frame em que foi visitado
+        uint64_t lastRequested = 0; // último frame em que foi pedido
+        size_t vertexOffset = 0, indexOffset = 0; // no VBO/EBO, em unidades
+        uint64_t ticket = 0;                      // última cópia pelo anel
+    };
+
+    // Geometria lida do disco à espera de upload
+    struct LoadedNode
+    {
+        uint32_t node;
+        std::vector<char> data; // vazio se a leitura falhou
+        bool allocated = false;
+        bool verticesWritten = false;
+    };
+
+    static constexpr size_t MAX_QUEUED_LOADS = 32;
+    static constexpr uint64_t STALE_FRAMES = 60; // nó lido que já não é pedido é descartado
+
+    std::string sourcePath;
+    std::vector<HlodFile::TreeRecord> trees;
+    std::vector<HlodFile::NodeRecord> nodes; // só leitura depois do construtor
+    std::vector<NodeState> state;            // só no thread de GL
+    uint64_t frame = 0;
+    size_t residentCount = 0;
+
+    RangeAllocator vertexAllocator, indexAllocator;
+    std::vector<LoadedNode> arrived; // vindos da thread de leitura, por enviar
+    std::vector<uint32_t> uploading; // à espera do submit do anel
+    StagingRing *uploadRing = nullptr;
+
+    // Seleção do frame
+    std::vector<uint32_t> drawList, stack;
+    std::vector<std::pair<float, uint32_t>> wanted; // (erro em pixels do pai, nó)
+
+    // Partilhado com a thread de leitura (protegido por mutex)
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<uint32_t> queue; // pedidos, o mais importante no fim
+    std::vector<LoadedNode> completed;
+    size_t cpuBudget;
+    size_t cpuBytes = 0; // lidos (ou a ler) e ainda não enviados
+    bool stopping = false;
+
+    // Um VBO/EBO para a geometria residente; DrawData e draw id por nó e
+    // materiais por árvore ficam em draws
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    IndirectDraw draws;
+    std::vector<DrawElementsIndirectCommand> commandScratch;
+
+    static glm::vec3 nodeCenter(const HlodFile::NodeRecord &node)
+    {
+        return glm::vec3(node.boundsMin[0] + node.boundsMax[0], node.boundsMin[1] + node.boundsMax[1],
+                         node.boundsMin[2] + node.boundsMax[2]) *
+               0.5f;
+    }
+
+    static bool nodeVisible(const Frustum &frustum, const HlodFile::NodeRecord &node)
+    {
+        return frustum.intersectsSphere(nodeCenter(node), node.radius) &&
+               frustum.intersectsBox(glm::vec3(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]),
+                                     glm::vec3(node.boundsMax[0], node.boundsMax[1], node.boundsMax[2]));
+    }
+
+    // Thread de leitura: o pedido mais importante primeiro, enquanto os
+    // bytes à espera de upload couberem em cpuBudget (pelo menos um nó)
+    void loadNodes()
+    {
+        std::ifstream file(sourcePath, std::ios::binary);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            wake.wait(lock, [this]()
+                      { return stopping ||
+                               (!queue.empty() && (cpuBytes == 0 ||
+                                                   cpuBytes + HlodFile::dataSize(nodes[queue.back()]) <= cpuBudget)); });
+            if (stopping)
+                return;
+
+            LoadedNode loaded;
+            loaded.node = queue.back();
+            queue.pop_back();
+            cpuBytes += HlodFile::dataSize(nodes[loaded.node]);
+            lock.unlock();
+
+            if (!HlodFile::readNode(file, nodes[loaded.node], loaded.data))
+            {
+                std::cout << "WARNING: could not read node " << loaded.node << " of " << sourcePath << std::endl;
+                loaded.data.clear();
+            }
+
+            lock.lock();
+            completed.push_back(std::move(loaded));
+        }
+    }
+
+    // Substitui a fila da thread de leitura pelos pedidos deste frame (os
+    // que ainda não começaram a ser lidos e deixaram de ser pedidos voltam
+    // a Absent)
+    void requestLoads()
+    {
+        std::sort(wanted.begin(), wanted.end(),
+                  [](const std::pair<float, uint32_t> &a, const std::pair<float, uint32_t> &b)
+                  { return a.first > b.first; });
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint32_t id : queue)
+                state[id].status = NodeStatus::Absent;
+            queue.clear();
+            for (const auto &request : wanted)
+            {
+                if (queue.size() == MAX_QUEUED_LOADS)
+                    break;
+                if (state[request.second].status != NodeStatus::Absent)
+                    continue;
+                state[request.second].status = NodeStatus::Requested;
+                queue.push_back(request.second);
+            }
+            std::reverse(queue.begin(), queue.end());
+        }
+        wake.notify_one();
+    }
+
+    bool allocate(uint32_t id)
+    {
+        const HlodFile::NodeRecord &node = nodes[id];
+        NodeState &s = state[id];
+        if (!vertexAllocator.allocate(node.vertexCount, s.vertexOffset))
+            return false;
+        if (!indexAllocator.allocate(node.indexCount, s.indexOffset))
+        {
+            vertexAllocator.release(s.vertexOffset, node.vertexCount);
+            return false;
+        }
+        return true;
+    }
+
+    // Liberta nós residentes (os usados há mais tempo primeiro) até haver
+    // espaço para o nó id. Só saem nós que não foram visitados neste frame,
+    // não são raízes e não têm filhos carregados ou a carregar.
+    bool evictFor(uint32_t id)
+    {
+        std::vector<std::pair<uint64_t, uint32_t>> candidates;
+        for (uint32_t n = 0; n < nodes.size(); ++n)
+        {
+            const HlodFile::NodeRecord &node = nodes[n];
+            if (state[n].status != NodeStatus::Resident || state[n].lastUsed >= frame ||
+                node.parent == HlodFile::NO_NODE)
+                continue;
+            if (!HlodFile::isLeaf(node) && (isLoaded(node.children[0]) || isLoaded(node.children[1])))
+                continue;
+            candidates.push_back({state[n].lastUsed, n});
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        const HlodFile::NodeRecord &needed = nodes[id];
+        for (const auto &candidate : candidates)
+        {
+            uint32_t n = candidate.second;
+            vertexAllocator.release(state[n].vertexOffset, nodes[n].vertexCount);
+            indexAllocator.release(state[n].indexOffset, nodes[n].indexCount);
+            state[n].status = NodeStatus::Absent;
+            residentCount--;
+
+            size_t vertexOffset, indexOffset;
+            if (vertexAllocator.allocate(needed.vertexCount, vertexOffset))
+            {
+                vertexAllocator.release(vertexOffset, needed.vertexCount);
+                if (indexAllocator.allocate(needed.indexCount, indexOffset))
+                {
+                    indexAllocator.release(indexOffset, needed.indexCount);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool isLoaded(uint32_t id) const
+    {
+        return state[id].status != NodeStatus::Absent && state[id].status != NodeStatus::Failed;
+    }
+
+    // Copia a geometria do nó (já alocado) para o VBO/EBO, pelo anel ou com
+    // glBufferSubData. Devolve false se o anel não tem espaço; verticesWritten
+    // guarda o progresso entre tentativas.
+    bool uploadNode(uint32_t id, const std::vector<char> &data, StagingRing *ring, bool *verticesWritten = nullptr)
+    {
+        const HlodFile::NodeRecord &node = nodes[id];
+        NodeState &s = state[id];
+        size_t vertexBytes = node.vertexCount * sizeof(PackedVertex);
+        size_t indexBytes = node.indexCount * sizeof(unsigned int);
+
+        if (ring)
+        {
+            if (!(verticesWritten && *verticesWritten) &&
+                !ring->write(VBO, s.vertexOffset * sizeof(PackedVertex), data.data(), vertexBytes, s.ticket))
+                return false;
+            if (verticesWritten)
+                *verticesWritten = true;
+            if (!ring->write(EBO, s.indexOffset * sizeof(unsigned int), data.data() + vertexBytes, indexBytes, s.ticket))
+                return false;
+            uploadRing = ring;
+            s.status = NodeStatus::Uploading;
+            uploading.push_back(id);
+            return true;
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, s.vertexOffset * sizeof(PackedVertex), vertexBytes, data.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, s.indexOffset * sizeof(unsigned int), indexBytes, data.data() + vertexBytes);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        s.status = NodeStatus::Resident;
+        residentCount++;
+        return true;
+    }
+
+    // Buffers com o tamanho do orçamento, VAO com o formato PackedVertex e
+    // as tabelas por nó (DrawData, draw ids) e por árvore (materiais)
+    void createBuffers()
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        draws.create();
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexAllocator.capacityUnits() * sizeof(PackedVertex), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexAllocator.capacityUnits() * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              (void *)offsetof(PackedVertex, position));
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              (void *)offsetof(PackedVertex, normal));
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        std::vector<DrawData> drawData(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            const HlodFile::NodeRecord &node = nodes[i];
+            drawData[i].positionOffset = glm::vec4(node.positionOffset[0], node.positionOffset[1], node.positionOffset[2], 1.0f);
+            drawData[i].positionScale = glm::vec4(node.positionScale[0], node.positionScale[1], node.positionScale[2], 0.0f);
+            drawData[i].materialIndex = node.tree < IndirectDraw::MAX_MATERIALS ? node.tree : 0;
+        }
+
+        if (trees.size() > IndirectDraw::MAX_MATERIALS)
+            std::cout << "WARNING: more than " << IndirectDraw::MAX_MATERIALS
+                      << " trees, using material 0 for the rest" << std::endl;
+        std::vector<GpuMaterial> materials;
+        for (const HlodFile::TreeRecord &tree : trees)
+        {
+            Material m;
+            m.ambient = glm::vec3(tree.ambient[0], tree.ambient[1], tree.ambient[2]);
+            m.diffuse = glm::vec3(tree.diffuse[0], tree.diffuse[1], tree.diffuse[2]);
+            m.specular = glm::vec3(tree.specular[0], tree.specular[1], tree.specular[2]);
+            m.shininess = tree.shininess;
+            materials.push_back(IndirectDraw::gpuMaterial(m));
+        }
+
+        draws.setupDrawIds(VAO, nodes.size());
+        draws.uploadDrawData(drawData);
+        draws.uploadMaterials(materials);
+        draws.reserve(nodes.size());
+    }
+
+    void destroyBuffers()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        GLuint buffers[] = {VBO, EBO};
+        glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers);
+        draws.destroy();
+        VAO = 0;
+    }
+
+    // Um comando por nó escolhido
+    void updateDrawCommands()
+    {
+        commandScratch.clear();
+        size_t backFaceCount = 0;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (uint32_t id : drawList)
+            {
+                const HlodFile::NodeRecord &node = nodes[id];
+                bool backFaces = (trees[node.tree].flags & HlodFile::FLAG_CULL_BACK_FACES) != 0;
+                if (backFaces != (pass == 0))
+                    continue;
+                commandScratch.push_back({node.indexCount, 1, (unsigned int)state[id].indexOffset,
+                                          (int)state[id].vertexOffset, id});
+                backFaceCount += backFaces ? 1 : 0;
+            }
+        }
+        draws.update(commandScratch.data(), commandScratch.size(), backFaceCount);
+    }
+};
+
+#endif
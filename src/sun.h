@@ -8,6 +8,9 @@
 #include <vector>
 #include <cmath>
 
+#include "frustum.h"
+#include "shader.h"
+
 class Sun
 {
 public:
@@ -15,28 +18,40 @@ public:
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     glm::vec3 position;
+    float radius;
 
     Sun(glm::vec3 pos = glm::vec3(30.0f, 25.0f, -20.0f))
     {
         position = pos;
-        createSphere(1.5f, 20, 20); // Raio 1.5 ; 20 x 20 subdvisões
+        radius = 1.5f;
+        createSphere(radius, 20, 20); // Raio 1.5 ; 20 x 20 subdvisões
         setupMesh();
     }
 
-    void Draw(unsigned int shaderProgram, const glm::mat4 &view, const glm::mat4 &projection)
+    Bounds getBounds() const
+    {
+        return Bounds::fromSphere(position, radius);
+    }
+
+    // view e projection vêm do bloco FrameData (FrameUniforms); os
+    // uniforms do programa são resolvidos uma vez (e de novo se mudar)
+    void Draw(Shader &shader)
     {
-        glUseProgram(shaderProgram);
+        shader.use();
+        if (shader.ID != uniformProgram)
+        {
+            modelUniform = shader.uniform<glm::mat4>("model");
+            colorUniform = shader.uniform<glm::vec3>("sunColor");
+            uniformProgram = shader.ID;
+        }
 
         // Criar modelo do sol
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, position);
-
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, &model[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+        modelUniform.set(model);
 
         // Cor do Sol
-        glUniform3f(glGetUniformLocation(shaderProgram, "sunColor"), 1.0f, 0.9f, 0.6f);
+        colorUniform.set(glm::vec3(1.0f, 0.9f, 0.6f));
 
         glBindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
@@ -51,6 +66,10 @@ public:
     }
 
 private:
+    unsigned int uniformProgram = 0;
+    Uniform<glm::mat4> modelUniform;
+    Uniform<glm::vec3> colorUniform;
+
     void createSphere(float radius, int sectorCount, int stackCount)
     {
         float x, y, z, xy;
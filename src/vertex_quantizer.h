@@ -0,0 +1,157 @@
+#ifndef VERTEX_QUANTIZER_H
+#define VERTEX_QUANTIZER_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mesh_types.h"
+
+// Vértice compacto (12 bytes): posição em unorm16 relativa à AABB do
+// SubMesh e normal octaédrica em snorm16. O w da posição só serve para
+// alinhar a normal a 4 bytes.
+struct PackedVertex
+{
+    uint16_t position[4];
+    int16_t normal[2];
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex deve ter 12 bytes");
+
+// Parâmetros de desquantização (posição = offset + aPos * scale) e o erro
+// medido depois de descodificar todos os vértices
+struct QuantizationInfo
+{
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    float maxPositionError = 0.0f; // unidades do modelo
+    float maxNormalError = 0.0f;   // graus
+};
+
+class VertexQuantizer
+{
+public:
+    static std::vector<PackedVertex> pack(const Vertex *vertices, size_t count, QuantizationInfo &info)
+    {
+        info = QuantizationInfo();
+        std::vector<PackedVertex> packed(count);
+        if (count == 0)
+            return packed;
+
+        glm::vec3 minP = vertices[0].Position, maxP = vertices[0].Position;
+        for (size_t i = 1; i < count; ++i)
+        {
+            minP = glm::min(minP, vertices[i].Position);
+            maxP = glm::max(maxP, vertices[i].Position);
+        }
+        info = paramsFor(minP, maxP);
+        packRange(vertices, count, info, packed.data());
+        return packed;
+    }
+
+    // Desquantização para a AABB [minP, maxP] (erros a zero)
+    static QuantizationInfo paramsFor(const glm::vec3 &minP, const glm::vec3 &maxP)
+    {
+        QuantizationInfo info;
+        info.offset = minP;
+        // eixos planos: escala 1 para não dividir por zero (aPos fica a 0)
+        info.scale = glm::max(maxP - minP, glm::vec3(0.0f));
+        for (int c = 0; c < 3; ++c)
+            if (info.scale[c] <= 0.0f)
+                info.scale[c] = 1.0f;
+        return info;
+    }
+
+    // Quantiza count vértices para out com o offset/scale de info (a AABB
+    // tem de os conter); os erros medidos acumulam-se (máximo) em info, por
+    // isso um SubMesh pode ser empacotado aos bocados
+    static void packRange(const Vertex *vertices, size_t count, QuantizationInfo &info, PackedVertex *out)
+    {
+        float maxCos = std::cos(glm::radians(info.maxNormalError));
+        for (size_t i = 0; i < count; ++i)
+        {
+            PackedVertex &p = out[i];
+            glm::vec3 t = (vertices[i].Position - info.offset) / info.scale;
+            for (int c = 0; c < 3; ++c)
+                p.position[c] = unorm16(t[c]);
+            p.position[3] = 0;
+            encodeNormal(vertices[i].Normal, p.normal);
+
+            glm::vec3 position = info.offset + glm::vec3(p.position[0], p.position[1], p.position[2]) / 65535.0f * info.scale;
+            glm::vec3 positionDelta = glm::abs(position - vertices[i].Position);
+            info.maxPositionError = std::max(info.maxPositionError,
+                                             std::max(positionDelta.x, std::max(positionDelta.y, positionDelta.z)));
+
+            float length = glm::length(vertices[i].Normal);
+            if (length > 0.0f)
+                maxCos = std::min(maxCos, glm::dot(decodeNormal(p.normal), vertices[i].Normal / length));
+        }
+        info.maxNormalError = std::max(info.maxNormalError, glm::degrees(std::acos(std::clamp(maxCos, -1.0f, 1.0f))));
+    }
+
+    // Mesma descodificação que o vertex.glsl
+    static glm::vec3 decodeNormal(const int16_t normal[2])
+    {
+        glm::vec2 e(std::max(normal[0] / 32767.0f, -1.0f), std::max(normal[1] / 32767.0f, -1.0f));
+        glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+        if (n.z < 0.0f)
+        {
+            n.x = (1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+            n.y = (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return glm::normalize(n);
+    }
+
+private:
+    static uint16_t unorm16(float v)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    static int16_t snorm16(float v)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    // Projeção no octaedro |x|+|y|+|z| = 1, com o hemisfério inferior
+    // dobrado sobre os cantos. Dos quatro arredondamentos vizinhos fica o
+    // que descodifica mais perto da normal original.
+    static void encodeNormal(const glm::vec3 &normal, int16_t out[2])
+    {
+        float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (l1 <= 0.0f)
+        {
+            out[0] = 0;
+            out[1] = 0;
+            return;
+        }
+
+        glm::vec3 n = normal / l1;
+        glm::vec2 e(n.x, n.y);
+        if (n.z < 0.0f)
+        {
+            e.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            e.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+
+        glm::vec3 target = glm::normalize(normal);
+        float best = -2.0f;
+        for (int i = 0; i < 4; ++i)
+        {
+            float x = (i & 1) ? std::ceil(e.x * 32767.0f) : std::floor(e.x * 32767.0f);
+            float y = (i & 2) ? std::ceil(e.y * 32767.0f) : std::floor(e.y * 32767.0f);
+            int16_t candidate[2] = {snorm16(x / 32767.0f), snorm16(y / 32767.0f)};
+            float d = glm::dot(decodeNormal(candidate), target);
+            if (d > best)
+            {
+                best = d;
+                out[0] = candidate[0];
+                out[1] = candidate[1];
+            }
+        }
+    }
+};
+
+#endif